@@ -30,7 +30,7 @@ TABSTOP = 4
 # the object files which make up your drivers.
 ##################################################
 #
-COMMON_OBJS = drivers/install_driver.o drivers/console_driver.o drivers/keyboard_driver.o drivers/timer_driver.o drivers/handler_helper.o
+COMMON_OBJS = drivers/install_driver.o drivers/irq.o drivers/console_driver.o drivers/console_printf.o drivers/keyboard_driver.o drivers/timer_driver.o drivers/timer_wheel.o drivers/event_queue.o drivers/handler_helper.o
 
 ##################################################
 # Object files from 410kern/ for just the game
@@ -47,7 +47,7 @@ COMMON_OBJS = drivers/install_driver.o drivers/console_driver.o drivers/keyboard
 # multiple parts.
 ##################################################
 #
-KERN_GAME_OBJS = game/game.o game/game_controller.o game/key_handler.o game/screen_painter.o game/gameplay_handler.o
+KERN_GAME_OBJS = game/game.o game/game_controller.o game/key_handler.o game/screen_painter.o game/gameplay_handler.o game/region.o game/bitboard.o game/solver.o game/hint.o game/console_bench.o
 
 ##################################################
 # Object files from 410kern/ for just the tester
@@ -55,3 +55,16 @@ KERN_GAME_OBJS = game/game.o game/game_controller.o game/key_handler.o game/scre
 ##################################################
 #
 410TEST_OBJS = 410_test.o
+
+##################################################
+# Interrupt profiling: set to 1 to have the entry
+# stubs time every interrupt (see irq.h). Off by
+# default, as it costs every interrupt two rdtsc
+# reads and the bookkeeping of the profile. Run
+# make clean after changing it.
+##################################################
+IRQ_PROFILE = 0
+ifeq ($(IRQ_PROFILE),1)
+$(STUKDIR)/drivers/irq.o $(STUKDIR)/drivers/handler_helper.o: \
+	CFLAGS += -DIRQ_PROFILE
+endif
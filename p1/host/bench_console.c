@@ -0,0 +1,155 @@
+/** @file bench_console.c
+ *
+ *  @brief Benchmarks of the console driver on the host. Each benchmark
+ *  runs on the unbuffered console, and on the buffered console with a
+ *  flush every BENCH_FLUSH_OPS operations, as the timer would flush it.
+ *  The wall time and the port I/O of each run are printed.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <p1kern.h>
+#include <drivers/inc/console_driver.h>
+
+#include "inc/host.h"
+
+/*Operations between flushes of the buffered console*/
+#define BENCH_FLUSH_OPS 64
+
+/*Operations of each benchmark*/
+#define PRINTF_OPS 20000
+#define SCROLL_OPS 200000
+#define CLEAR_OPS 20000
+#define DRAW_OPS 1000000
+
+/*Characters printed by each printf() of the printf benchmark*/
+#define PRINTF_TEXT_LENGTH 2000
+#define PRINTF_LINE_LENGTH 80
+
+/*The console versions of printf() and puts(), renamed by the build*/
+int console_printf(const char *, ...);
+int console_puts(const char *);
+
+char printf_text[PRINTF_TEXT_LENGTH + 1];
+
+/*Helper functions*/
+static void run(const char *, void (*)(int), int, int);
+static void bulk_printf(int);
+static void scroll_storm(int);
+static void clear_storm(int);
+static void random_draw_char(int);
+
+/**
+ * @brief Runs the benchmarks.
+ *
+ * @return 0
+ */
+int main() {
+	int i, buffered;
+
+	for(i=0; i<PRINTF_TEXT_LENGTH; i++) {
+		printf_text[i] = (i%PRINTF_LINE_LENGTH == PRINTF_LINE_LENGTH-1) ?
+			'\n' : 'a' + i%26;
+	}
+	printf_text[PRINTF_TEXT_LENGTH] = '\0';
+
+	printf("%-18s %-10s %10s %12s %10s %10s %12s\n", "benchmark", "console",
+			"ops", "ms", "ops/s", "outb", "outb/op");
+	for(buffered=0; buffered<=1; buffered++) {
+		run("bulk printf", bulk_printf, PRINTF_OPS, buffered);
+		run("scroll storm", scroll_storm, SCROLL_OPS, buffered);
+		run("clear storm", clear_storm, CLEAR_OPS, buffered);
+		run("random draw_char", random_draw_char, DRAW_OPS, buffered);
+	}
+	return 0;
+}
+
+/**
+ * @brief Times a benchmark and prints its results.
+ *
+ * @param name Name of the benchmark
+ * @param op Function which runs one operation of the benchmark
+ * @param ops Number of operations
+ * @param buffered 1 to run on the buffered console
+ *
+ * @return Void
+ */
+void run(const char *name, void (*op)(int), int ops, int buffered) {
+	host_io io;
+	int i;
+
+	console_set_buffered(buffered);
+	clear_console();
+	console_flush();
+	srand(1);
+
+	host_io_reset();
+	uint64_t start = host_ns();
+	for(i=0; i<ops; i++) {
+		op(i);
+		if(buffered && i%BENCH_FLUSH_OPS == BENCH_FLUSH_OPS-1) {
+			console_flush();
+		}
+	}
+	console_flush();
+	uint64_t ns = host_ns() - start;
+	host_io_get(&io);
+
+	console_set_buffered(0);
+	printf("%-18s %-10s %10d %12.2f %10.0f %10lu %12.3f\n", name,
+			buffered ? "buffered" : "direct", ops, ns/1e6, ops*1e9/ns,
+			io.outb, (double)io.outb/ops);
+}
+
+/**
+ * @brief Prints a screenful of text with a single printf().
+ *
+ * @param i Number of the operation
+ *
+ * @return Void
+ */
+void bulk_printf(int i) {
+	console_printf("%s", printf_text);
+}
+
+/**
+ * @brief Prints a short line, which scrolls the console once the
+ * cursor has reached the bottom.
+ *
+ * @param i Number of the operation
+ *
+ * @return Void
+ */
+void scroll_storm(int i) {
+	console_printf("line %d\n", i);
+}
+
+/**
+ * @brief Clears the console, and prints a character on it so that
+ * the next clear has something to do.
+ *
+ * @param i Number of the operation
+ *
+ * @return Void
+ */
+void clear_storm(int i) {
+	clear_console();
+	putbyte('x');
+}
+
+/**
+ * @brief Draws a character of a random color at a random position.
+ *
+ * @param i Number of the operation
+ *
+ * @return Void
+ */
+void random_draw_char(int i) {
+	int r = rand();
+
+	draw_char((r/CONSOLE_WIDTH)%CONSOLE_HEIGHT, r%CONSOLE_WIDTH,
+			'a' + (r>>12)%26, (r>>16)&0xFF);
+}
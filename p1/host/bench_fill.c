@@ -0,0 +1,150 @@
+/** @file bench_fill.c
+ *
+ *  @brief Benchmark of the scanline flood fill of region.c on the host,
+ *  on boards up to 255x255, much larger than the game's. The game code
+ *  is built with MAX_BOARD_SIZE raised for it. Three kinds of fill are
+ *  timed for each size:
+ *
+ *  whole board - a board of a single color, filled from the corner
+ *  snake - a single path which winds through every other row, the
+ *  worst case for the depth of a recursive fill
+ *  random game - the fills of the moves of games on random boards of
+ *  6 colors, each move playing the next color after the region's
+ *
+ *  Each kind is repeated for at least BENCH_NS, and the fills per second
+ *  and the cells filled per second are printed.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <game/inc/region.h>
+
+#include "inc/host.h"
+#include "inc/host_game.h"
+
+/*Time each kind of fill is repeated for, in ns*/
+#define BENCH_NS 200000000ULL
+
+/*Colors of the random boards*/
+#define RANDOM_COLORS 6
+
+char grid[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+
+/*Helper functions*/
+static void run(const char *, int, void (*)(int));
+static void fill_whole_board(int);
+static void fill_snake(int);
+static void play_random_game(int);
+
+/*Fills and cells filled by the kind of fill being run*/
+unsigned long fills, cells;
+
+/**
+ * @brief Runs the benchmark on boards of a few sizes.
+ *
+ * @return 0
+ */
+int main() {
+	static const int sizes[] = {14, 32, 64, 128, 255};
+	int i;
+
+	printf("%-12s %5s %10s %10s %12s %14s\n", "fill", "size", "fills",
+			"ms", "fills/s", "cells/s");
+	for(i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+		run("whole board", sizes[i], fill_whole_board);
+		run("snake", sizes[i], fill_snake);
+		run("random game", sizes[i], play_random_game);
+	}
+	return 0;
+}
+
+/**
+ * @brief Repeats a kind of fill for at least BENCH_NS, and prints its
+ * results.
+ *
+ * @param name Name of the kind of fill
+ * @param size Length and height of the boards
+ * @param fill Function which runs the fill, and counts it
+ *
+ * @return Void
+ */
+void run(const char *name, int size, void (*fill)(int)) {
+	uint64_t start = host_ns(), ns;
+
+	srand(1);
+	fills = 0;
+	cells = 0;
+	do {
+		fill(size);
+		ns = host_ns() - start;
+	} while(ns < BENCH_NS);
+
+	printf("%-12s %5d %10lu %10.1f %12.0f %14.0f\n", name, size, fills,
+			ns/1e6, fills*1e9/ns, cells*1e9/ns);
+}
+
+/**
+ * @brief Fills a board of a single color from the corner.
+ *
+ * @param size Length and height of the board
+ *
+ * @return Void
+ */
+void fill_whole_board(int size) {
+	int i, j;
+
+	for(i=0; i<size; i++) {
+		for(j=0; j<size; j++) {
+			grid[i][j] = 0;
+		}
+	}
+	cells += init_region(grid, size);
+	fills++;
+}
+
+/**
+ * @brief Fills a path which runs along every even row, and goes down
+ * to the next one at alternate ends of the odd rows.
+ *
+ * @param size Length and height of the board
+ *
+ * @return Void
+ */
+void fill_snake(int size) {
+	int i, j;
+
+	for(i=0; i<size; i++) {
+		for(j=0; j<size; j++) {
+			int path = (i%2 == 0) ||
+				(j == ((i%4 == 1) ? size-1 : 0));
+			grid[i][j] = path ? 0 : COLOR_CODE_MULTIPLIER;
+		}
+	}
+	cells += init_region(grid, size);
+	fills++;
+}
+
+/**
+ * @brief Plays a game on a random board until it is flooded. Every
+ * move is a fill.
+ *
+ * @param size Length and height of the board
+ *
+ * @return Void
+ */
+void play_random_game(int size) {
+	int color;
+
+	host_deal(grid, size, RANDOM_COLORS);
+	init_region(grid, size);
+	while(region_size < size*size) {
+		int before = region_size;
+		color = (grid[0][0]/COLOR_CODE_MULTIPLIER + 1)%RANDOM_COLORS;
+		flood_region(color*COLOR_CODE_MULTIPLIER);
+		cells += region_size - before;
+		fills++;
+	}
+}
@@ -0,0 +1,139 @@
+/** @file bench_region.c
+ *
+ *  @brief Benchmark of the incremental tracking of the flooded region
+ *  on the host. The same games are played twice: with flood_region(),
+ *  which only fills from the frontier of the region, and by recoloring
+ *  the region and filling it again from the corner on every move, as
+ *  the game did before the region was kept across moves. The moves per
+ *  second of both are printed, along with the cells a move has to
+ *  redraw: the cells which changed color, against the whole board.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <game/inc/region.h>
+
+#include "inc/host.h"
+#include "inc/host_game.h"
+
+/*Time each way of playing is repeated for, in ns*/
+#define BENCH_NS 200000000ULL
+
+char grid[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+
+/*Moves played, and cells which changed color, by the run*/
+unsigned long moves, changed;
+
+/*Helper functions*/
+static double run(int, int, int);
+static int next_color(int);
+static void play_incremental(int, int);
+static void play_refill(int, int);
+
+/**
+ * @brief Runs the benchmark on boards of a few sizes and colors.
+ *
+ * @return 0
+ */
+int main() {
+	static const int sizes[] = {14, 14, 64, 255};
+	static const int colors[] = {4, 8, 6, 6};
+	int i;
+
+	printf("%5s %6s %14s %14s %8s %16s\n", "size", "colors",
+			"incremental/s", "refill/s", "speedup", "redrawn/move");
+	for(i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+		int n = sizes[i];
+		double incremental = run(n, colors[i], 1);
+		double redrawn = (double)changed/moves;
+		double refill = run(n, colors[i], 0);
+
+		printf("%5d %6d %14.0f %14.0f %7.1fx %7.1f of %6d\n", n, colors[i],
+				incremental, refill, incremental/refill, redrawn, n*n);
+	}
+	return 0;
+}
+
+/**
+ * @brief Plays games on random boards for at least BENCH_NS.
+ *
+ * @param size Length and height of the boards
+ * @param colors Number of colors of the boards
+ * @param incremental 1 to play with flood_region(), 0 to fill the
+ * region again on every move
+ *
+ * @return Moves per second
+ */
+double run(int size, int colors, int incremental) {
+	uint64_t start = host_ns(), ns;
+
+	srand(1);
+	moves = 0;
+	changed = 0;
+	do {
+		host_deal(grid, size, colors);
+		if(incremental) {
+			play_incremental(size, colors);
+		} else {
+			play_refill(size, colors);
+		}
+		ns = host_ns() - start;
+	} while(ns < BENCH_NS);
+
+	return moves*1e9/ns;
+}
+
+/**
+ * @brief Finds the color to play next, which is the one after the
+ * color of the region.
+ *
+ * @param colors Number of colors of the board
+ *
+ * @return The color, as stored in the grid
+ */
+int next_color(int colors) {
+	return ((grid[0][0]/COLOR_CODE_MULTIPLIER + 1)%colors)*
+		COLOR_CODE_MULTIPLIER;
+}
+
+/**
+ * @brief Plays a game with the region kept across moves.
+ *
+ * @param size Length and height of the board
+ * @param colors Number of colors of the board
+ *
+ * @return Void
+ */
+void play_incremental(int size, int colors) {
+	init_region(grid, size);
+	while(region_size < size*size) {
+		changed += flood_region(next_color(colors));
+		moves++;
+	}
+}
+
+/**
+ * @brief Plays a game by recoloring the region and filling it again
+ * from the corner on every move.
+ *
+ * @param size Length and height of the board
+ * @param colors Number of colors of the board
+ *
+ * @return Void
+ */
+void play_refill(int size, int colors) {
+	int i;
+
+	init_region(grid, size);
+	while(region_size < size*size) {
+		char color = next_color(colors);
+		for(i=0; i<region_size; i++) {
+			grid[region_cells[i].x][region_cells[i].y] = color;
+		}
+		init_region(grid, size);
+		moves++;
+	}
+}
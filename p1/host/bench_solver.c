@@ -0,0 +1,99 @@
+/** @file bench_solver.c
+ *
+ *  @brief Benchmark of the quality and the time of the Flood-It solver
+ *  on the host. The solver is run as the game runs it at the start of
+ *  a game, with SOLVER_BUDGET_NS, on BENCH_BOARDS random boards of
+ *  every size and color count the game offers. For each, the moves of
+ *  the solutions, the boards solved optimally, and the mean and worst
+ *  time taken are printed, along with the boards on which the solver
+ *  overran its budget by more than BENCH_OVERRUN_NS. The game code is
+ *  built for the game's boards here, as the solver copies positions
+ *  whole.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <game/inc/region.h>
+#include <game/inc/bitboard.h>
+#include <game/inc/solver.h>
+
+#include "inc/host.h"
+#include "inc/host_game.h"
+
+/*Random boards solved for each size and color count*/
+#define BENCH_BOARDS 200
+
+/*Overrun of the budget which is counted. The solver checks the time
+  every few positions, so it always ends a little after the budget*/
+#define BENCH_OVERRUN_NS (SOLVER_BUDGET_NS/10)
+
+char grid[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+bb_game board_bits;
+bitboard region_bits;
+
+/*Helper functions*/
+static void run(int, int);
+
+/**
+ * @brief Runs the benchmark on the boards of the game.
+ *
+ * @return 0
+ */
+int main() {
+	int i, j;
+
+	printf("solving %d boards per setting, budget %.1f ms\n", BENCH_BOARDS,
+			SOLVER_BUDGET_NS/1e6);
+	printf("%5s %6s %10s %9s %10s %10s %6s\n", "size", "colors", "moves",
+			"optimal", "mean ms", "worst ms", "over");
+	for(i=0; i<BOARD_SIZE_COUNT; i++) {
+		for(j=0; j<COLOR_COUNT; j++) {
+			run(board_type[i], color_count[j]);
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Solves BENCH_BOARDS random boards, and prints the results.
+ *
+ * @param size Length and height of the boards
+ * @param colors Number of colors of the boards
+ *
+ * @return Void
+ */
+void run(int size, int colors) {
+	solver_result solved;
+	unsigned long moves = 0;
+	uint64_t ns = 0, worst = 0;
+	int i, optimal = 0, over = 0;
+
+	srand(1);
+	for(i=0; i<BENCH_BOARDS; i++) {
+		host_deal(grid, size, colors);
+		init_region(grid, size);
+		bb_load(&board_bits, grid, size, colors);
+		bb_clear(&region_bits);
+		bb_add_cells(&board_bits, &region_bits, region_cells, region_size);
+		solve_board(&board_bits, &region_bits,
+					grid[0][0]/COLOR_CODE_MULTIPLIER, SOLVER_BUDGET_NS,
+					&solved);
+
+		moves += solved.moves;
+		optimal += solved.optimal;
+		ns += solved.ns;
+		if(solved.ns > worst) {
+			worst = solved.ns;
+		}
+		if(solved.ns > SOLVER_BUDGET_NS + BENCH_OVERRUN_NS) {
+			over++;
+		}
+	}
+
+	printf("%5d %6d %10.2f %8.1f%% %10.3f %10.3f %6d\n", size, colors,
+			(double)moves/BENCH_BOARDS, optimal*100.0/BENCH_BOARDS,
+			ns/1e6/BENCH_BOARDS, worst/1e6, over);
+}
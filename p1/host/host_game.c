@@ -0,0 +1,33 @@
+/** @file host_game.c
+ *
+ *  @brief Helpers of the host benchmarks of the game engine. This file
+ *  is built with the MAX_BOARD_SIZE of each benchmark, as the grid is
+ *  passed in with it.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdlib.h>
+
+#include "inc/host_game.h"
+
+/**
+ * @brief Deals a random board, with rand(), so that a benchmark deals
+ * the same boards on every run once it has seeded it.
+ *
+ * @param grid 2D array to be filled with the grid colors
+ * @param size Length and height of the board
+ * @param colors Number of colors of the board
+ *
+ * @return Void
+ */
+void host_deal(char grid[][MAX_BOARD_SIZE], int size, int colors) {
+	int i, j;
+
+	for(i=0; i<size; i++) {
+		for(j=0; j<size; j++) {
+			grid[i][j] = (rand()%colors)*COLOR_CODE_MULTIPLIER;
+		}
+	}
+}
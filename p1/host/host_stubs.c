@@ -0,0 +1,195 @@
+/** @file host_stubs.c
+ *
+ *  @brief Emulated hardware of the host build. Port writes and reads
+ *  are counted. Writes to the CRTC registers are kept, so that the
+ *  position of the hardware cursor can be read back. A read from a
+ *  port returns the last value set for it with host_set_port(). The
+ *  interrupt flag is a variable, and the Simics console is stdout.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <asm.h>
+#include <eflags.h>
+#include <simics.h>
+
+#include "inc/host.h"
+
+/*Number of CRTC registers*/
+#define CRTC_REGS 256
+
+uint16_t host_video[CONSOLE_WIDTH*CONSOLE_HEIGHT];
+
+host_io io;
+uint8_t port_values[HOST_PORTS]; /*Values read from the ports*/
+uint8_t crtc_index; /*Register selected through CRTC_IDX_REG*/
+uint8_t crtc_regs[CRTC_REGS];
+uint32_t eflags = EFL_IF;
+
+/**
+ * @brief Function to write a byte to a port.
+ *
+ * @param port The port
+ * @param val The byte
+ *
+ * @return Void
+ */
+void outb(uint16_t port, uint8_t val) {
+	io.outb++;
+	if(port == CRTC_IDX_REG) {
+		crtc_index = val;
+		io.crtc++;
+	} else if(port == CRTC_DATA_REG) {
+		crtc_regs[crtc_index] = val;
+		io.crtc++;
+	}
+}
+
+/**
+ * @brief Function to read a byte from a port.
+ *
+ * @param port The port
+ *
+ * @return The last value set for the port, 0 if none was
+ */
+uint8_t inb(uint16_t port) {
+	io.inb++;
+	return port_values[port];
+}
+
+/**
+ * @brief Function to set the value read from a port.
+ *
+ * @param port The port
+ * @param val The value
+ *
+ * @return Void
+ */
+void host_set_port(uint16_t port, uint8_t val) {
+	port_values[port] = val;
+}
+
+/**
+ * @brief Function to reset the counts of port I/O.
+ *
+ * @return Void
+ */
+void host_io_reset() {
+	memset(&io, 0, sizeof(io));
+}
+
+/**
+ * @brief Function to get the counts of port I/O.
+ *
+ * @param out The address to which the counts will be written
+ *
+ * @return Void
+ */
+void host_io_get(host_io *out) {
+	*out = io;
+}
+
+/**
+ * @brief Function to get the position of the hardware cursor, as
+ * programmed in the CRTC.
+ *
+ * @return Position of the cursor
+ */
+int host_cursor() {
+	return (crtc_regs[CRTC_CURSOR_MSB_IDX] << 8) |
+		crtc_regs[CRTC_CURSOR_LSB_IDX];
+}
+
+/**
+ * @brief Function to check the emulated interrupt flag.
+ *
+ * @return 1 if interrupts are enabled, 0 if not
+ */
+int host_interrupts_enabled() {
+	return (eflags & EFL_IF) != 0;
+}
+
+/**
+ * @brief Function to read the host's monotonic clock.
+ *
+ * @return Time in nanoseconds
+ */
+uint64_t host_ns() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Function to read the emulated flags register. Only the
+ * interrupt flag is kept.
+ *
+ * @return The flags
+ */
+uint32_t get_eflags() {
+	return eflags;
+}
+
+/**
+ * @brief Function to write the emulated flags register.
+ *
+ * @param value The flags
+ *
+ * @return Void
+ */
+void set_eflags(uint32_t value) {
+	eflags = value;
+}
+
+/**
+ * @brief Function to clear the emulated interrupt flag.
+ *
+ * @return Void
+ */
+void disable_interrupts() {
+	eflags &= ~EFL_IF;
+}
+
+/**
+ * @brief Function to set the emulated interrupt flag.
+ *
+ * @return Void
+ */
+void enable_interrupts() {
+	eflags |= EFL_IF;
+}
+
+/**
+ * @brief Function to read the time stamp counter of the host.
+ *
+ * @return The time stamp counter
+ */
+uint64_t rdtsc() {
+	uint32_t lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((uint64_t)hi << 32) | lo;
+}
+
+/**
+ * @brief Function to print a line on the Simics console, which is
+ * stdout on the host.
+ *
+ * @param fmt Format string
+ *
+ * @return Void
+ */
+void sim_printf(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+	putchar('\n');
+}
@@ -0,0 +1,45 @@
+/** @file host_timer.c
+ *
+ *  @brief Timer of the host build, for the drivers and the game code
+ *  which read the time. There is no PIT: the clock is the host's
+ *  monotonic clock, and the ticks are counted from it at 100 Hz.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <drivers/inc/timer_driver.h>
+
+#include "inc/host.h"
+
+/*Length of a tick, in ns*/
+#define HOST_TICK_NS 10000000
+
+/**
+ * @brief Function to get the time since an arbitrary point, in
+ * nanoseconds.
+ *
+ * @return Time in nanoseconds
+ */
+uint64_t timer_ns() {
+	return host_ns();
+}
+
+/**
+ * @brief Function to get the number of ticks since an arbitrary
+ * point.
+ *
+ * @return Tick count
+ */
+unsigned int timer_ticks() {
+	return (unsigned int)(host_ns()/HOST_TICK_NS);
+}
+
+/**
+ * @brief Function called by the software timers when a timer is
+ * started. There is no PIT to program again.
+ *
+ * @return Void
+ */
+void timer_deadline_changed() {
+}
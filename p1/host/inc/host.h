@@ -0,0 +1,36 @@
+/** @file host.h
+ *  @brief Interface for the emulated hardware of the host build.
+ *  The drivers are built unchanged, against video memory in a host
+ *  buffer and port I/O which is counted and, for the CRTC, emulated.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __host_h
+#define __host_h
+
+#include <stdint.h>
+#include <video_defines.h>
+
+/*Number of I/O ports*/
+#define HOST_PORTS 0x10000
+
+/*Port I/O made so far*/
+typedef struct host_io {
+	unsigned long outb; /*Writes to all ports*/
+	unsigned long inb; /*Reads from all ports*/
+	unsigned long crtc; /*Writes to the CRTC index and data ports*/
+} host_io;
+
+/*Video memory of the console. The build points CONSOLE_VIDEO_MEM here*/
+extern uint16_t host_video[CONSOLE_WIDTH*CONSOLE_HEIGHT];
+
+void host_io_reset(void);
+void host_io_get(host_io *);
+void host_set_port(uint16_t, uint8_t);
+int host_cursor(void);
+int host_interrupts_enabled(void);
+uint64_t host_ns(void);
+
+#endif
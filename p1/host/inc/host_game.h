@@ -0,0 +1,15 @@
+/** @file host_game.h
+ *  @brief Header file for host_game.c
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __host_game_h
+#define __host_game_h
+
+#include <game/inc/game_controller.h>
+
+void host_deal(char [][MAX_BOARD_SIZE], int, int);
+
+#endif
@@ -0,0 +1,23 @@
+/** @file types.h
+ *  @brief Host version of 410kern/inc/types.h, which multiboot.h
+ *  includes. The kernel's version defines size_t for i386, so the
+ *  host's definition is used instead.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __types_h
+#define __types_h
+
+#include <stddef.h>
+
+typedef unsigned long vm_offset_t;
+typedef unsigned long vm_size_t;
+
+typedef enum {
+	FALSE = 0,
+	TRUE
+} boolean_t;
+
+#endif
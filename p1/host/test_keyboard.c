@@ -0,0 +1,140 @@
+/** @file test_keyboard.c
+ *
+ *  @brief Stress test of the scancode ring of the keyboard driver. A
+ *  producer thread stands in for the interrupt handler, and calls
+ *  add_to_keyboard_buffer() with the scancode set on the keyboard
+ *  port, while the main thread reads the keys with readchar(), as
+ *  the event loop of the game does. Each key is a press and a release
+ *  of a letter of TEST_KEYS, in turn.
+ *
+ *  In the first phase, the producer waits for room in the ring, like
+ *  a keyboard typing no faster than the keys are read, and every key
+ *  must arrive, in order. In the second, it does not wait, and every
+ *  scancode must either be read or counted as dropped, and the keys
+ *  which arrive must be in order.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <p1kern.h>
+#include <keyhelp.h>
+#include <drivers/inc/keyboard_driver.h>
+
+#include "inc/host.h"
+
+/*Keys pressed, and their set 1 scancodes*/
+#define TEST_KEYS "qwertyuiop"
+#define TEST_KEY_COUNT 10
+#define TEST_FIRST_SCANCODE 0x10
+#define SCANCODE_RELEASE 0x80
+
+/*Size of the ring in keyboard_driver.c*/
+#define KEY_BUFFER_SIZE 256
+
+/*Keys pressed in each phase*/
+#define TEST_PRESSES 50000
+
+/*Indices of the ring, kept by keyboard_driver.c*/
+extern volatile unsigned int key_head, key_tail;
+
+/*Phase being run, and whether the producer is done with it*/
+int paced;
+volatile int producer_done;
+
+/*Helper functions*/
+static void *producer(void *);
+static int run_phase(int);
+
+/**
+ * @brief Runs both phases of the test.
+ *
+ * @return 0 if the test passed, 1 if not
+ */
+int main() {
+	int failed = run_phase(1) || run_phase(0);
+
+	printf("test_keyboard: %s\n", failed ? "FAILED" : "passed");
+	return failed;
+}
+
+/**
+ * @brief Runs a phase of the test, and checks its results.
+ *
+ * @param pace 1 if the producer waits for room in the ring
+ *
+ * @return 0 if the phase passed, 1 if not
+ */
+int run_phase(int pace) {
+	pthread_t thread;
+	unsigned int dropped = keyboard_dropped_keys(), reads;
+	unsigned int read_before, received = 0, expected = 0;
+	uint64_t total, max;
+	int ch, last = 0;
+
+	keyboard_latency(&read_before, &total, &max);
+	paced = pace;
+	producer_done = 0;
+	pthread_create(&thread, NULL, producer, NULL);
+
+	while(!producer_done || key_head != key_tail) {
+		if((ch = readchar()) == -1) {
+			continue;
+		}
+		/*Keys may only be lost if the producer does not wait*/
+		while(TEST_KEYS[expected%TEST_KEY_COUNT] != ch) {
+			expected++;
+			if(pace || expected >= TEST_PRESSES) {
+				printf("phase %d: key %u is '%c', expected '%c'\n", pace,
+						received, ch, TEST_KEYS[last%TEST_KEY_COUNT]);
+				return 1;
+			}
+		}
+		last = ++expected;
+		received++;
+	}
+	pthread_join(thread, NULL);
+
+	dropped = keyboard_dropped_keys() - dropped;
+	keyboard_latency(&reads, &total, &max);
+	reads -= read_before;
+
+	printf("phase %s: %u keys pressed, %u received, %u scancodes read, "
+			"%u dropped\n", pace ? "paced" : "flooded", TEST_PRESSES,
+			received, reads, dropped);
+	if(reads + dropped != 2*TEST_PRESSES) {
+		printf("scancodes read and dropped do not add up to %u\n",
+				2*TEST_PRESSES);
+		return 1;
+	}
+	if(pace && (received != TEST_PRESSES || dropped != 0)) {
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Presses and releases the keys, through the interrupt handler
+ * of the keyboard driver.
+ *
+ * @param arg Unused
+ *
+ * @return NULL
+ */
+void *producer(void *arg) {
+	int i, scancode;
+
+	for(i=0; i<2*TEST_PRESSES; i++) {
+		scancode = TEST_FIRST_SCANCODE + (i/2)%TEST_KEY_COUNT;
+		if(i%2) {
+			scancode |= SCANCODE_RELEASE;
+		}
+		while(paced && key_tail - key_head == KEY_BUFFER_SIZE);
+		host_set_port(KEYBOARD_PORT, scancode);
+		add_to_keyboard_buffer();
+	}
+	producer_done = 1;
+	return NULL;
+}
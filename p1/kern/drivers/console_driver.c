@@ -12,22 +12,98 @@
 #include <asm.h>
 #include <stdint.h>
 #include <string.h>
+#include <eflags.h>
+
+#include "inc/console_driver.h"
 
 #define CONSOLE_SIZE (CONSOLE_WIDTH*CONSOLE_HEIGHT)
+
+/*Video memory of the console. Can be redefined at build time to run
+  the driver against an emulated console, for example on the host with
+  outb() and the eflags functions stubbed out.*/
+#ifndef CONSOLE_VIDEO_MEM
+#define CONSOLE_VIDEO_MEM ((uint16_t *)CONSOLE_MEM_BASE)
+#endif
 #define CURSOR_INVISIBLE ((CONSOLE_WIDTH*CONSOLE_HEIGHT)+1)
 
 #define COLOR_MIN 0
 #define COLOR_MAX 255
 
+#define ALL_ROWS_DIRTY ((1<<CONSOLE_HEIGHT)-1)
+
+/*ANSI escape sequence constants*/
+#define ESC '\033'
+#define ESC_MAX_PARAMS 16
+#define ESC_MAX_PARAM_VALUE 9999
+#define FGND_MASK 0x0F
+#define BGND_MASK 0x70
+#define FGND_BRIGHT 0x08
+#define DEFAULT_COLOR FGND_WHITE
+
+/*States of the escape sequence parser*/
+enum esc_state {
+	ESC_NONE, /*Not in an escape sequence*/
+	ESC_START, /*ESC received*/
+	ESC_CSI /*ESC [ received, reading parameters*/
+};
+
+/*Number of rows kept by the shadow framebuffer, including the rows
+  on the screen. Rows scrolled off the screen stay available for
+  scrolling back until they are reused.*/
+#ifndef CONSOLE_HISTORY_ROWS
+#define CONSOLE_HISTORY_ROWS 1000
+#endif
+#define SCROLLBACK_ROWS (CONSOLE_HISTORY_ROWS-CONSOLE_HEIGHT)
+
 static void set_hardware_cursor(int);
+static void sync_hardware_cursor(void);
 static void scroll_console();
+static void scroll_rows(int);
 static void set_char_at_pos(char, char, int);
 static void process_char(char);
+static int layout_char(char, int *, int *);
+static void put_batch(const char *, int);
+static void process_escape_char(char);
+static void run_escape_sequence(char);
+static void select_graphic_rendition(void);
+static void erase_cells(int, int);
+static int escape_param(int, int);
+static int is_special_char(char);
+static uint16_t *cell_at(int);
+static uint16_t make_cell(char, char);
+static void fill_rect(int, int, int, int, uint16_t);
+static void fill_cells(uint16_t *, int, uint16_t);
+static void copy_cells(uint16_t *, const uint16_t *, int);
+static int is_valid_rect(int, int, int, int);
+static void mark_row_dirty(int);
 
 int cur_pos = 0; //Keeps track of the current position of the cursor
 int cursor_visible = 1; //Boolean to keep track whether cursor is visible
+int hw_cursor_pos = -1; //Position last programmed in the CRTC, -1 if unknown
+unsigned int port_writes = 0; //Number of port writes made by the driver
 char cur_color = FGND_WHITE; //Keeps track of the current color
 
+/*Shadow framebuffer. The rows are used as a ring, and screen row r
+  is stored in shadow[(shadow_top+r)%CONSOLE_HISTORY_ROWS]. The rows
+  before shadow_top hold the lines scrolled off the screen.*/
+uint16_t shadow[CONSOLE_HISTORY_ROWS][CONSOLE_WIDTH];
+int shadow_top = 0; //Row of the shadow buffer at the top of the console
+int history_len = 0; //Number of scrolled off rows in the shadow buffer
+volatile int view_offset = 0; //Number of rows the view is scrolled back by
+int console_buffered = 0; //Boolean to keep track whether drawing is buffered
+volatile uint32_t dirty_rows = 0; //Bitmap of screen rows yet to be flushed
+
+/*State of the escape sequence being received. Sequences can be split
+  across calls to putbyte() and putbytes().*/
+enum esc_state esc_state = ESC_NONE;
+int esc_params[ESC_MAX_PARAMS]; //Numeric parameters of the sequence
+int esc_nparams = 0; //Number of parameters started so far
+
+/*Maps ANSI color numbers (black, red, green, yellow, blue, magenta,
+  cyan, white) to VGA foreground colors*/
+static const char ansi_colors[8] = {FGND_BLACK, FGND_RED, FGND_GREEN, 
+	FGND_BRWN, FGND_BLUE, FGND_MAG, FGND_CYAN, FGND_LGRAY};
+
 
 /**
  * @brief Puts a character in the current position of the cursor, and 
@@ -35,7 +111,10 @@ char cur_color = FGND_WHITE; //Keeps track of the current color
  * the cursor goes beyond the last possible valid value (depending on
  * the size of the console), the console is scrolled by one row.
  *
- * Special characters such as '\n', '\r' and '\b' are handled separately.
+ * Special characters such as '\n', '\r' and '\b' are handled separately,
+ * and so are ANSI escape sequences (see process_escape_char()).
+ * The hardware cursor is moved at the next synchronization point
+ * (see console_flush()).
  *
  * @param ch The character to be printed in the console at the current
  * position
@@ -44,6 +123,11 @@ char cur_color = FGND_WHITE; //Keeps track of the current color
  *
  */
 int putbyte(char ch) {
+	if(esc_state != ESC_NONE || ch == ESC) {
+		process_escape_char(ch);
+		return (int)ch;
+	}
+
 	process_char(ch);
 	
 	//If current position is beyond console size, scroll one row
@@ -51,10 +135,6 @@ int putbyte(char ch) {
 		scroll_console();
 	}
 
-	if(cursor_visible) {
-		set_hardware_cursor(cur_pos);
-	}
-
 	return (int)ch;
 }
 
@@ -64,7 +144,13 @@ int putbyte(char ch) {
  * by the length of the string to be printed. If the string is longer
  * than the current line, the string is continued to be printed in the
  * next line. If the string exceeds the available space in the console,
- * the console is scrolled up by one row, and the string will be printed.
+ * the console is scrolled up as many rows as needed, and the string will
+ * be printed.
+ *
+ * The string may contain ANSI escape sequences to set colors, move the
+ * cursor and erase parts of the console. The text between escape
+ * sequences is printed in batches (see put_batch()), and the hardware
+ * cursor is synchronized only once at the end.
  *
  * @param s The string to be printed
  * @param len Length of the string to be printed
@@ -72,10 +158,109 @@ int putbyte(char ch) {
  * @return Void
  */
 void putbytes(const char *s, int len) {
-	int i;
+	int i = 0;
+
+	if(s == NULL || len <= 0) {
+		return;
+	}
+
+	while(i < len) {
+		if(esc_state != ESC_NONE || s[i] == ESC) {
+			process_escape_char(s[i++]);
+			continue;
+		}
+
+		int end = i;
+		while(end < len && s[end] != ESC) {
+			end++;
+		}
+		put_batch(s+i, end-i);
+		i = end;
+	}
+
+	sync_hardware_cursor();
+}
+
+/**
+ * @brief Prints a string without escape sequences as a batch: the
+ * number of rows to scroll by is worked out up front so that the
+ * console is scrolled at most once, and runs of printable characters
+ * are written straight into video memory. When drawing is buffered,
+ * the rows the string scrolls past the screen are written into the
+ * history, as if they had been printed one row at a time.
+ *
+ * @param s The string to be printed
+ * @param len Length of the string to be printed
+ *
+ * @return Void
+ */
+void put_batch(const char *s, int len) {
+	int i, vpos, top, scroll, base, limit;
+
+	//First pass: find out how many rows the whole string scrolls by
+	vpos = cur_pos;
+	top = 0;
 	for(i = 0; i < len; i++) {
-		putbyte(s[i]);
+		layout_char(s[i], &vpos, &top);
+	}
+	scroll = top;
+	scroll_rows(scroll);
+
+	//Second pass: replay the string against the already scrolled
+	//console. Cells which would have been scrolled off are skipped,
+	//unless they are kept in the history.
+	base = scroll*CONSOLE_WIDTH;
+	limit = base;
+	if(console_buffered) {
+		limit -= ((scroll < SCROLLBACK_ROWS) ? scroll : SCROLLBACK_ROWS)
+					*CONSOLE_WIDTH;
 	}
+	vpos = cur_pos;
+	top = 0;
+	i = 0;
+	while(i < len) {
+		if(is_special_char(s[i])) {
+			int pos = layout_char(s[i], &vpos, &top);
+			if(pos >= limit) {
+				set_char_at_pos(' ', cur_color, pos-base);
+			}
+			i++;
+			continue;
+		}
+
+		//Run of printable characters, written as consecutive cells
+		int end = i;
+		while(end < len && !is_special_char(s[end])) {
+			end++;
+		}
+		int start = vpos;
+		vpos += end - i;
+		if(vpos/CONSOLE_WIDTH - top >= CONSOLE_HEIGHT) {
+			top = vpos/CONSOLE_WIDTH - CONSOLE_HEIGHT + 1;
+		}
+		if(start < limit) {
+			//Skip the part of the run which is scrolled off
+			i = (end-i > limit-start) ? i+(limit-start) : end;
+			start = limit;
+		}
+		uint16_t attr = ((uint16_t)(uint8_t)cur_color)<<8;
+		while(i < end) {
+			//Rows are not contiguous in the shadow buffer, so the run
+			//is written one row at a time
+			int count = CONSOLE_WIDTH - (start%CONSOLE_WIDTH);
+			if(count > end-i) {
+				count = end-i;
+			}
+			int row = start/CONSOLE_WIDTH - scroll;
+			uint16_t *cell = cell_at(start-base);
+			start += count;
+			for(; count > 0; count--) {
+				*cell++ = attr | (uint8_t)s[i++];
+			}
+			mark_row_dirty(row);
+		}
+	}
+	cur_pos = vpos - base;
 }
 
 /**
@@ -110,7 +295,8 @@ void get_term_color(int *color) {
 /**
  * @brief Sets the logical cursor to the position defined
  * by row and column. Subsequent prints will be continued
- * from the new position of the cursor.
+ * from the new position of the cursor. The hardware cursor
+ * follows at the next synchronization point.
  *
  * @param row The new row of the cursor
  * @param col The new column of the cursor
@@ -123,9 +309,6 @@ int set_cursor(int row, int col) {
 		return -1;
 	}
 	cur_pos = pos;
-	if(cursor_visible) {
-		set_hardware_cursor(cur_pos);
-	}
 	return 0;
 }
 
@@ -150,8 +333,8 @@ void get_cursor(int *row, int *col) {
  * @return Void
  */
 void hide_cursor() {
-	set_hardware_cursor(CURSOR_INVISIBLE);
 	cursor_visible = 0;
+	sync_hardware_cursor();
 }
 
 /**
@@ -165,7 +348,7 @@ void show_cursor() {
 		return;
 	}
 	cursor_visible=1;
-	set_hardware_cursor(cur_pos);
+	sync_hardware_cursor();
 }
 
 /**
@@ -175,13 +358,7 @@ void show_cursor() {
  * @return Void
  */
 void clear_console() {
-	int i, j;
-	cur_pos = 0;
-	for(i = 0; i < CONSOLE_HEIGHT; i++) {
-		for(j = 0; j < CONSOLE_WIDTH; j++) {
-			putbyte(' ');
-		}
-	}
+	fill_rect(0, 0, CONSOLE_WIDTH, CONSOLE_HEIGHT, make_cell(' ', cur_color));
 	cur_pos = 0;
 }
 
@@ -205,6 +382,88 @@ void draw_char(int row, int col, int ch, int color) {
 	set_char_at_pos(ch, color, pos);
 }
 
+/**
+ * @brief Fills a rectangle of the console with the given character
+ * and color. The rectangle is validated once, and each of its rows
+ * is filled two cells at a time.
+ *
+ * @param row Top row of the rectangle
+ * @param col Left column of the rectangle
+ * @param width Width of the rectangle
+ * @param height Height of the rectangle
+ * @param ch Character to fill the rectangle with
+ * @param color Color to fill the rectangle with
+ *
+ * @return 0 if successful, -1 if the rectangle does not fit in the
+ * console or the color is invalid
+ */
+int draw_rect(int row, int col, int width, int height, int ch, int color) {
+	if(!is_valid_rect(row, col, width, height) ||
+		(color < COLOR_MIN || color > COLOR_MAX)) {
+		return -1;
+	}
+	fill_rect(row-1, col-1, width, height, make_cell(ch, color));
+	return 0;
+}
+
+/**
+ * @brief Copies a rectangle of cells to the console. Each cell is
+ * a character in the low byte and its color in the high byte (see
+ * CONSOLE_CELL()), and the cells are laid out row after row.
+ *
+ * @param row Top row of the rectangle
+ * @param col Left column of the rectangle
+ * @param width Width of the rectangle
+ * @param height Height of the rectangle
+ * @param cells Cells to be copied, width*height of them
+ *
+ * @return 0 if successful, -1 if the rectangle does not fit in the
+ * console
+ */
+int blit_cells(int row, int col, int width, int height, 
+				const uint16_t *cells) {
+	int i;
+	if(!is_valid_rect(row, col, width, height) || cells == NULL) {
+		return -1;
+	}
+	for(i = row-1; i < row-1+height; i++) {
+		copy_cells(cell_at((i*CONSOLE_WIDTH)+(col-1)), cells, width);
+		mark_row_dirty(i);
+		cells += width;
+	}
+	return 0;
+}
+
+/**
+ * @brief Sets the color of a rectangle of the console, without
+ * changing the characters in it.
+ *
+ * @param row Top row of the rectangle
+ * @param col Left column of the rectangle
+ * @param width Width of the rectangle
+ * @param height Height of the rectangle
+ * @param color New color of the rectangle
+ *
+ * @return 0 if successful, -1 if the rectangle does not fit in the
+ * console or the color is invalid
+ */
+int set_attr_rect(int row, int col, int width, int height, int color) {
+	int i, j;
+	if(!is_valid_rect(row, col, width, height) ||
+		(color < COLOR_MIN || color > COLOR_MAX)) {
+		return -1;
+	}
+	uint16_t attr = make_cell(0, color);
+	for(i = row-1; i < row-1+height; i++) {
+		uint16_t *cell = cell_at((i*CONSOLE_WIDTH)+(col-1));
+		for(j = 0; j < width; j++) {
+			cell[j] = (cell[j] & 0xFF) | attr;
+		}
+		mark_row_dirty(i);
+	}
+	return 0;
+}
+
 /** 
  * @brief Returns the character displayed at position (row, col).
  *
@@ -215,7 +474,7 @@ void draw_char(int row, int col, int ch, int color) {
  */
 char get_char(int row, int col) {
 	int pos = (((row-1)*CONSOLE_WIDTH) + (col-1));
-	return *(char *)(CONSOLE_MEM_BASE + (2*pos));
+	return (char)*cell_at(pos);
 }
 
 /**
@@ -256,11 +515,35 @@ void process_char(char ch) {
  * @return void
  */
 void set_hardware_cursor(int position) {
+	//The index and data writes must not be split by a sync from
+	//the timer interrupt
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
 	outb(CRTC_IDX_REG, CRTC_CURSOR_LSB_IDX);
 	outb(CRTC_DATA_REG, (uint8_t)position);
 
 	outb(CRTC_IDX_REG, CRTC_CURSOR_MSB_IDX);
 	outb(CRTC_DATA_REG, (uint8_t)(position>>8));
+
+	port_writes += 4;
+	hw_cursor_pos = position;
+
+	set_eflags(eflags);
+}
+
+/**
+ * @brief Programs the hardware cursor with the position of the
+ * logical cursor, or hides it, if it differs from what was last
+ * programmed in the CRTC.
+ *
+ * @return Void
+ */
+void sync_hardware_cursor() {
+	int position = cursor_visible ? cur_pos : CURSOR_INVISIBLE;
+	if(position != hw_cursor_pos) {
+		set_hardware_cursor(position);
+	}
 }
 
 /**
@@ -268,22 +551,110 @@ void set_hardware_cursor(int position) {
  *
  */
 void scroll_console() {
-	int i;
+	scroll_rows(1);
 
-	//Shift rows up by one row
-	int copysize = (2*((CONSOLE_WIDTH*CONSOLE_HEIGHT)-CONSOLE_WIDTH));
-	memmove((void *)CONSOLE_MEM_BASE, 
-			(void *)(CONSOLE_MEM_BASE+(2*CONSOLE_WIDTH)), 
-			copysize);
+	//Set the cursor position appropriately
+	cur_pos -= CONSOLE_WIDTH;
+}
 
-	//Set the last row to empty
-	for(i = 0; i < CONSOLE_WIDTH; i++) {
-		int pos = ((CONSOLE_HEIGHT-1)*CONSOLE_WIDTH)+i;
-		set_char_at_pos(' ', cur_color, pos);
+/**
+ * @brief Scrolls the contents of the console up by the given
+ * number of rows in a single move, and empties the rows uncovered
+ * at the bottom. The cursor position is not changed. When drawing is
+ * buffered, the console can scroll by more rows than it has: the new
+ * rows which have already passed into the history are emptied too.
+ *
+ * @param rows Number of rows to scroll by
+ * @return Void
+ */
+void scroll_rows(int rows) {
+	if(rows <= 0) {
+		return;
 	}
 
-	//Set the cursor position appropriately
-	cur_pos -= CONSOLE_WIDTH;
+	if(console_buffered) {
+		//Rotate the ring of rows; every screen row has moved.
+		//The oldest rows of history are reused for the new rows.
+		shadow_top = (shadow_top+rows)%CONSOLE_HISTORY_ROWS;
+		history_len += rows;
+		if(history_len > SCROLLBACK_ROWS) {
+			history_len = SCROLLBACK_ROWS;
+		}
+		//Keep showing the same rows if the view is scrolled back
+		if(view_offset) {
+			int offset = view_offset + rows;
+			view_offset = (offset > history_len) ? history_len : offset;
+		}
+		if(rows > CONSOLE_HISTORY_ROWS) {
+			rows = CONSOLE_HISTORY_ROWS;
+		}
+	} else {
+		if(rows > CONSOLE_HEIGHT) {
+			rows = CONSOLE_HEIGHT;
+		}
+		//Shift rows up by the given number of rows
+		int copysize = (2*CONSOLE_WIDTH*(CONSOLE_HEIGHT-rows));
+		memmove(CONSOLE_VIDEO_MEM, CONSOLE_VIDEO_MEM+(CONSOLE_WIDTH*rows), 
+				copysize);
+	}
+
+	//Set the uncovered rows to empty
+	fill_rect(CONSOLE_HEIGHT-rows, 0, CONSOLE_WIDTH, rows, 
+				make_cell(' ', cur_color));
+
+	if(console_buffered) {
+		dirty_rows = ALL_ROWS_DIRTY;
+	}
+}
+
+/**
+ * @brief Lays out a character on an unbounded console, the same
+ * way process_char() and putbyte() would, without touching video
+ * memory. Used by putbytes() to work out an entire string before
+ * printing it.
+ *
+ * @param ch Character to be laid out
+ * @param vpos Virtual cursor position, counted from the first row
+ * of the console before the string was printed
+ * @param top Number of rows the console has scrolled by so far
+ *
+ * @return Virtual position of the cell written by the character,
+ * -1 if the character does not write a cell
+ */
+int layout_char(char ch, int *vpos, int *top) {
+	int written = -1;
+	switch(ch) {
+		case '\n':
+			*vpos += CONSOLE_WIDTH - (*vpos%CONSOLE_WIDTH);
+			break;
+		case '\r':
+			*vpos -= *vpos%CONSOLE_WIDTH;
+			break;
+		case '\b':
+			if(*vpos > (*top)*CONSOLE_WIDTH) {
+				(*vpos)--;
+			}
+			written = *vpos;
+			break;
+		default:
+			written = (*vpos)++;
+			break;
+	}
+	if((*vpos/CONSOLE_WIDTH) - *top >= CONSOLE_HEIGHT) {
+		*top = (*vpos/CONSOLE_WIDTH) - CONSOLE_HEIGHT + 1;
+	}
+	return written;
+}
+
+/**
+ * @brief Checks if a character is handled specially by the console
+ * instead of being printed as is.
+ *
+ * @param ch Character to be checked
+ * @return 1 if the character is special, 0 if not
+ */
+int is_special_char(char ch) {
+	return (ch == '\n' || ch == '\r' || ch == '\b');
 }
 
 /**
@@ -295,6 +666,449 @@ void scroll_console() {
  * @return Void
  */
 void set_char_at_pos(char ch, char color, int pos) {
-	*(char *)(CONSOLE_MEM_BASE + (2*pos)) = ch;
-	*(char *)(CONSOLE_MEM_BASE + (2*pos)+1) = color;
+	*cell_at(pos) = make_cell(ch, color);
+	mark_row_dirty(pos/CONSOLE_WIDTH);
+}
+
+/**
+ * @brief Packs a character and its color into the 16 bit value
+ * stored for a cell in video memory.
+ *
+ * @param ch Character of the cell
+ * @param color Color of the cell
+ * @return The cell value
+ */
+uint16_t make_cell(char ch, char color) {
+	return CONSOLE_CELL(ch, color);
+}
+
+/**
+ * @brief Checks if a rectangle, given by its top left corner in
+ * console coordinates and its size, lies within the console.
+ *
+ * @param row Top row of the rectangle
+ * @param col Left column of the rectangle
+ * @param width Width of the rectangle
+ * @param height Height of the rectangle
+ * @return 1 if the rectangle is valid, 0 if not
+ */
+int is_valid_rect(int row, int col, int width, int height) {
+	return (row >= 1 && col >= 1 && width >= 0 && height >= 0 &&
+			(row-1+height) <= CONSOLE_HEIGHT && 
+			(col-1+width) <= CONSOLE_WIDTH);
+}
+
+/**
+ * @brief Fills a rectangle of the console with the same cell value.
+ * Each row of the rectangle is filled with fill_cells(). The rectangle
+ * is expected to be within the console.
+ *
+ * @param row First row (0 based) of the rectangle
+ * @param col First column (0 based) of the rectangle
+ * @param width Width of the rectangle
+ * @param height Height of the rectangle
+ * @param cell Cell value to fill the rectangle with
+ * @return Void
+ */
+void fill_rect(int row, int col, int width, int height, uint16_t cell) {
+	int i;
+	for(i = row; i < row+height; i++) {
+		fill_cells(cell_at((i*CONSOLE_WIDTH)+col), width, cell);
+		mark_row_dirty(i);
+	}
+}
+
+/**
+ * @brief Fills consecutive cells with the same cell value. Two cells
+ * are written at a time using 32 bit stores, with 16 bit stores for
+ * the unaligned cells at either end.
+ *
+ * @param dst Address of the first cell
+ * @param count Number of cells to be filled
+ * @param cell Cell value to fill the cells with
+ * @return Void
+ */
+void fill_cells(uint16_t *dst, int count, uint16_t cell) {
+	if(count > 0 && ((uintptr_t)dst & 2)) {
+		*dst++ = cell;
+		count--;
+	}
+
+	uint32_t pair = ((uint32_t)cell<<16) | cell;
+	uint32_t *wide = (uint32_t *)dst;
+	for(; count >= 2; count -= 2) {
+		*wide++ = pair;
+	}
+
+	if(count) {
+		*(uint16_t *)wide = cell;
+	}
+}
+
+/**
+ * @brief Returns the address of the cell at the specified
+ * position. The cell is in the shadow buffer if drawing is
+ * buffered, and in video memory if not. When drawing is buffered,
+ * negative positions are in the rows of history above the screen.
+ *
+ * @param pos Position of the cell
+ * @return Address of the cell
+ */
+uint16_t *cell_at(int pos) {
+	if(console_buffered) {
+		int row = pos/CONSOLE_WIDTH, col = pos%CONSOLE_WIDTH;
+		if(col < 0) {
+			col += CONSOLE_WIDTH;
+			row--;
+		}
+		row = (shadow_top + CONSOLE_HISTORY_ROWS + row)%CONSOLE_HISTORY_ROWS;
+		return &shadow[row][col];
+	}
+	return CONSOLE_VIDEO_MEM + pos;
+}
+
+/**
+ * @brief Marks a row of the screen to be copied to video memory
+ * by the next flush. Has no effect if drawing is not buffered.
+ * The row must be marked after the cells have been written, so that
+ * a flush from the timer interrupt never misses a change.
+ * If the view is scrolled back, the row is shown further down the
+ * screen, or not at all.
+ *
+ * @param row Console row (0 based) which has been modified. Negative
+ * for a row of history
+ * @return Void
+ */
+void mark_row_dirty(int row) {
+	if(console_buffered) {
+		row += view_offset;
+		if(row >= 0 && row < CONSOLE_HEIGHT) {
+			dirty_rows |= (1<<row);
+		}
+	}
+}
+
+/**
+ * @brief Enables or disables buffered drawing. When enabled, all
+ * drawing goes to a shadow framebuffer in memory, and reaches the
+ * screen only when console_flush() is called. The timer driver
+ * flushes the console on every tick.
+ *
+ * @param enable 1 to buffer drawing, 0 to draw directly on the screen
+ *
+ * @return Void
+ */
+void console_set_buffered(int enable) {
+	if(enable && !console_buffered) {
+		memcpy(shadow, CONSOLE_VIDEO_MEM, 2*CONSOLE_SIZE);
+		shadow_top = 0;
+		history_len = 0;
+		view_offset = 0;
+		dirty_rows = 0;
+		console_buffered = 1;
+	} else if(!enable && console_buffered) {
+		console_scroll_view(-view_offset);
+		console_flush();
+		console_buffered = 0;
+	}
+}
+
+/**
+ * @brief Returns the number of port writes made by the console
+ * driver so far, to measure the cost of cursor updates.
+ *
+ * @return Number of port writes
+ */
+unsigned int console_port_writes() {
+	return port_writes;
+}
+
+/**
+ * @brief Scrolls the view of the console back into the rows which
+ * have scrolled off the screen, or forward towards the current rows.
+ * The view stays on the same rows as more output is printed, until it
+ * is scrolled forward again. Only available when drawing is buffered.
+ *
+ * @param rows Number of rows to scroll the view back by. Negative
+ * values scroll the view forward.
+ *
+ * @return Void
+ */
+void console_scroll_view(int rows) {
+	if(!console_buffered) {
+		return;
+	}
+	int offset = view_offset + rows;
+	if(offset < 0) {
+		offset = 0;
+	} else if(offset > history_len) {
+		offset = history_len;
+	}
+	if(offset != view_offset) {
+		view_offset = offset;
+		dirty_rows = ALL_ROWS_DIRTY;
+	}
+}
+
+/**
+ * @brief Brings the screen up to date with the console. Copies the rows
+ * of the shadow framebuffer that have been modified since the last flush
+ * to video memory, and synchronizes the hardware cursor with the logical
+ * cursor. Rows are copied two cells at a time using 32 bit stores. If
+ * the view is scrolled back, the rows shown are taken from the history.
+ *
+ * @return Void
+ */
+void console_flush() {
+	int row, i;
+
+	sync_hardware_cursor();
+
+	if(!console_buffered) {
+		return;
+	}
+
+	for(row = 0; row < CONSOLE_HEIGHT && dirty_rows; row++) {
+		if(!(dirty_rows & (1<<row))) {
+			continue;
+		}
+		//Clear the bit before copying, so that a change made while
+		//the row is being copied marks it dirty again
+		dirty_rows &= ~(1<<row);
+
+		int src_row = (shadow_top + CONSOLE_HISTORY_ROWS - view_offset + row)
+							%CONSOLE_HISTORY_ROWS;
+		uint32_t *src = (uint32_t *)shadow[src_row];
+		uint32_t *dst = (uint32_t *)CONSOLE_VIDEO_MEM + 
+							(row*(CONSOLE_WIDTH/2));
+		for(i = 0; i < CONSOLE_WIDTH/2; i++) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+/**
+ * @brief Copies consecutive cells. If the source and destination are
+ * aligned the same way, two cells are copied at a time using 32 bit
+ * loads and stores.
+ *
+ * @param dst Address of the first cell to be written
+ * @param src Address of the first cell to be copied
+ * @param count Number of cells to be copied
+ * @return Void
+ */
+void copy_cells(uint16_t *dst, const uint16_t *src, int count) {
+	if(((uintptr_t)dst & 2) != ((uintptr_t)src & 2)) {
+		for(; count > 0; count--) {
+			*dst++ = *src++;
+		}
+		return;
+	}
+
+	if(count > 0 && ((uintptr_t)dst & 2)) {
+		*dst++ = *src++;
+		count--;
+	}
+
+	uint32_t *wide_dst = (uint32_t *)dst;
+	const uint32_t *wide_src = (const uint32_t *)src;
+	for(; count >= 2; count -= 2) {
+		*wide_dst++ = *wide_src++;
+	}
+
+	if(count) {
+		*(uint16_t *)wide_dst = *(const uint16_t *)wide_src;
+	}
+}
+
+/**
+ * @brief Feeds a character to the ANSI escape sequence parser. The
+ * sequences understood are the CSI sequences
+ *
+ * ESC [ n;n;... m - select graphic rendition (colors, bold, blink)
+ * ESC [ row;col H (or f) - move the cursor
+ * ESC [ n J - erase the display (0: to the end, 1: to the cursor, 2: all)
+ * ESC [ n K - erase the line (0: to the end, 1: to the cursor, 2: all)
+ *
+ * Unknown sequences are dropped.
+ *
+ * @param ch Next character of the escape sequence
+ * @return Void
+ */
+void process_escape_char(char ch) {
+	switch(esc_state) {
+		case ESC_NONE:
+			esc_state = ESC_START;
+			break;
+		case ESC_START:
+			if(ch == '[') {
+				esc_state = ESC_CSI;
+				esc_nparams = 0;
+				esc_params[0] = 0;
+			} else {
+				esc_state = ESC_NONE;
+			}
+			break;
+		case ESC_CSI:
+			if(ch >= '0' && ch <= '9') {
+				if(esc_nparams == 0) {
+					esc_nparams = 1;
+				}
+				int *param = &esc_params[esc_nparams-1];
+				*param = (*param*10) + (ch-'0');
+				if(*param > ESC_MAX_PARAM_VALUE) {
+					*param = ESC_MAX_PARAM_VALUE;
+				}
+			} else if(ch == ';') {
+				if(esc_nparams == 0) {
+					esc_nparams = 1;
+				}
+				if(esc_nparams < ESC_MAX_PARAMS) {
+					esc_params[esc_nparams++] = 0;
+				}
+			} else if(ch >= '@' && ch <= '~') {
+				esc_state = ESC_NONE;
+				run_escape_sequence(ch);
+			} else {
+				esc_state = ESC_NONE;
+			}
+			break;
+	}
+}
+
+/**
+ * @brief Runs a complete CSI escape sequence, with the parameters
+ * collected in esc_params.
+ *
+ * @param final Final character of the sequence
+ * @return Void
+ */
+void run_escape_sequence(char final) {
+	int row, col;
+
+	switch(final) {
+		case 'm':
+			select_graphic_rendition();
+			break;
+		case 'H':
+		case 'f':
+			row = escape_param(0, 1);
+			col = escape_param(1, 1);
+			row = (row > CONSOLE_HEIGHT) ? CONSOLE_HEIGHT : row;
+			col = (col > CONSOLE_WIDTH) ? CONSOLE_WIDTH : col;
+			cur_pos = ((row-1)*CONSOLE_WIDTH) + (col-1);
+			break;
+		case 'J':
+			switch(escape_param(0, 0)) {
+				case 0:
+					erase_cells(cur_pos, CONSOLE_SIZE);
+					break;
+				case 1:
+					erase_cells(0, cur_pos+1);
+					break;
+				case 2:
+					erase_cells(0, CONSOLE_SIZE);
+					break;
+			}
+			break;
+		case 'K':
+			row = cur_pos - (cur_pos%CONSOLE_WIDTH);
+			switch(escape_param(0, 0)) {
+				case 0:
+					erase_cells(cur_pos, row+CONSOLE_WIDTH);
+					break;
+				case 1:
+					erase_cells(row, cur_pos+1);
+					break;
+				case 2:
+					erase_cells(row, row+CONSOLE_WIDTH);
+					break;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief Runs an SGR (select graphic rendition) escape sequence,
+ * updating the current color. Supports reset (0), bold (1, 22),
+ * blink (5, 25), foreground (30-37, 39, 90-97) and background
+ * (40-47, 49, 100-107) colors. Bright backgrounds are shown with
+ * their normal color.
+ *
+ * @return Void
+ */
+void select_graphic_rendition() {
+	int i;
+	int color = (uint8_t)cur_color;
+
+	if(esc_nparams == 0) {
+		cur_color = DEFAULT_COLOR;
+		return;
+	}
+
+	for(i = 0; i < esc_nparams; i++) {
+		int param = esc_params[i];
+		if(param == 0) {
+			color = DEFAULT_COLOR;
+		} else if(param == 1) {
+			color |= FGND_BRIGHT;
+		} else if(param == 22) {
+			color &= ~FGND_BRIGHT;
+		} else if(param == 5) {
+			color |= BLINK;
+		} else if(param == 25) {
+			color &= ~BLINK;
+		} else if(param >= 30 && param <= 37) {
+			//Keeps the bold attribute
+			color = (color & ~(FGND_MASK^FGND_BRIGHT)) | ansi_colors[param-30];
+		} else if(param == 39) {
+			color = (color & ~FGND_MASK) | (DEFAULT_COLOR & FGND_MASK);
+		} else if(param >= 90 && param <= 97) {
+			color = (color & ~FGND_MASK) | ansi_colors[param-90] | FGND_BRIGHT;
+		} else if(param >= 40 && param <= 47) {
+			color = (color & ~BGND_MASK) | (ansi_colors[param-40]<<4);
+		} else if(param >= 100 && param <= 107) {
+			color = (color & ~BGND_MASK) | (ansi_colors[param-100]<<4);
+		} else if(param == 49) {
+			color = (color & ~BGND_MASK) | (DEFAULT_COLOR & BGND_MASK);
+		}
+	}
+	cur_color = (char)color;
+}
+
+/**
+ * @brief Erases the cells in a range of positions with blanks of the
+ * current color. The cursor is not moved.
+ *
+ * @param from First position to be erased
+ * @param to Position after the last one to be erased
+ * @return Void
+ */
+void erase_cells(int from, int to) {
+	uint16_t blank = make_cell(' ', cur_color);
+	while(from < to) {
+		int count = CONSOLE_WIDTH - (from%CONSOLE_WIDTH);
+		if(count > to-from) {
+			count = to-from;
+		}
+		fill_cells(cell_at(from), count, blank);
+		mark_row_dirty(from/CONSOLE_WIDTH);
+		from += count;
+	}
+}
+
+/**
+ * @brief Returns a parameter of the current escape sequence.
+ *
+ * @param index Index of the parameter
+ * @param def Value to be used if the parameter is missing or 0
+ * @return Value of the parameter
+ */
+int escape_param(int index, int def) {
+	if(index >= esc_nparams || esc_params[index] == 0) {
+		return def;
+	}
+	return esc_params[index];
 }
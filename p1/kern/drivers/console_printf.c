@@ -0,0 +1,114 @@
+/** @file console_printf.c
+ *
+ *  @brief Console versions of printf(), vprintf() and puts().
+ *  The versions in 410kern/stdio print through putchar(), one
+ *  putbyte() at a time. These replace them so that the formatted
+ *  output is handed to the console driver in batches via putbytes().
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <p1kern.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <doprnt.h>
+
+#define PRINTF_BUFMAX 256
+
+/**
+ * Struct to hold the characters formatted by _doprnt() until
+ * they are flushed to the console.
+ */
+struct printf_state {
+	char buf[PRINTF_BUFMAX];
+	int index;
+};
+
+/*Helper functions*/
+static void printf_flush(struct printf_state *);
+static void printf_char(char *, int);
+
+/**
+ * @brief Prints a formatted string on the console.
+ *
+ * @param fmt Format string
+ * @param args Arguments for the format string
+ *
+ * @return 0
+ */
+int vprintf(const char *fmt, va_list args) {
+	struct printf_state state;
+
+	state.index = 0;
+	_doprnt(fmt, args, 0, (void (*)())printf_char, (char *)&state);
+	printf_flush(&state);
+
+	return 0;
+}
+
+/**
+ * @brief Prints a formatted string on the console.
+ *
+ * @param fmt Format string
+ *
+ * @return 0
+ */
+int printf(const char *fmt, ...) {
+	va_list args;
+	int err;
+
+	va_start(args, fmt);
+	err = vprintf(fmt, args);
+	va_end(args);
+
+	return err;
+}
+
+/**
+ * @brief Prints a string followed by a newline on the console.
+ * The newline is printed with putbytes() too, as putbyte() leaves
+ * the hardware cursor to be moved by the next flush.
+ *
+ * @param s String to be printed
+ *
+ * @return 0
+ */
+int puts(const char *s) {
+	putbytes(s, strlen(s));
+	putbytes("\n", 1);
+	return 0;
+}
+
+/**
+ * @brief Function called by _doprnt() for every formatted
+ * character. The character is buffered, and the buffer is
+ * flushed to the console when it is full.
+ *
+ * @param arg The printf_state of the current call
+ * @param c Character to be printed
+ *
+ * @return Void
+ */
+void printf_char(char *arg, int c) {
+	struct printf_state *state = (struct printf_state *)arg;
+
+	if(state->index >= PRINTF_BUFMAX) {
+		printf_flush(state);
+	}
+	state->buf[state->index++] = (char)c;
+}
+
+/**
+ * @brief Prints all the buffered characters with a single
+ * call to putbytes().
+ *
+ * @param state The printf_state of the current call
+ *
+ * @return Void
+ */
+void printf_flush(struct printf_state *state) {
+	putbytes(state->buf, state->index);
+	state->index = 0;
+}
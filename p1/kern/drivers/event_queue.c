@@ -0,0 +1,114 @@
+/** @file event_queue.c
+ *
+ *  @brief A bounded queue of events, posted by the interrupt
+ *  handlers and drained by a single dispatcher loop. This lets the
+ *  handlers do a constant amount of work, and leaves everything
+ *  else, such as drawing, to the dispatcher outside interrupt
+ *  context.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <p1kern.h>
+#include <asm.h>
+#include <eflags.h>
+
+#include "inc/handler_helper.h"
+#include "inc/event_queue.h"
+
+/*Size of the event queue. Must be a power of two*/
+#define EVENT_QUEUE_SIZE 64
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE-1)
+
+/**
+ * The event queue. The indices run freely and are masked when used,
+ * so the queue is empty when they are equal and full when they are
+ * EVENT_QUEUE_SIZE apart. Events are posted with interrupts disabled,
+ * so the handlers of different interrupts never post at the same time.
+ */
+event event_queue[EVENT_QUEUE_SIZE];
+volatile unsigned int event_head = 0; /*Next event to be read*/
+volatile unsigned int event_tail = 0; /*Next free slot*/
+volatile unsigned int dropped_events = 0; /*Events lost to a full queue*/
+
+/**
+ * @brief Function to post an event to the end of the queue. Can be
+ * called from interrupt handlers. If the queue is full, the event is
+ * dropped and counted.
+ *
+ * @param type Type of the event
+ * @param data Data of the event
+ *
+ * @return 0 if the event was posted, -1 if the queue is full
+ */
+int post_event(enum event_type type, unsigned int data) {
+	int ret = 0;
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	unsigned int tail = event_tail;
+	if(tail - event_head == EVENT_QUEUE_SIZE) {
+		dropped_events++;
+		ret = -1;
+	} else {
+		event_queue[tail & EVENT_QUEUE_MASK].type = type;
+		event_queue[tail & EVENT_QUEUE_MASK].data = data;
+		COMPILER_BARRIER(); /*Write the event before publishing it*/
+		event_tail = tail + 1;
+	}
+
+	set_eflags(eflags);
+	return ret;
+}
+
+/**
+ * @brief Function to remove the first event from the queue. Must
+ * only be called by the dispatcher loop. Does not block.
+ *
+ * @param ev The address to which the event will be written
+ *
+ * @return 1 if an event was removed, 0 if the queue is empty
+ */
+int get_event(event *ev) {
+	unsigned int head = event_head;
+	if(head == event_tail) {
+		return 0;
+	}
+
+	*ev = event_queue[head & EVENT_QUEUE_MASK];
+	COMPILER_BARRIER(); /*Read the event before giving the slot back*/
+	event_head = head + 1;
+	return 1;
+}
+
+/**
+ * @brief Function to remove the first event from the queue, blocking
+ * until there is one. While the queue is empty, the CPU is halted until
+ * the next interrupt. The queue is checked with interrupts disabled, so
+ * an event posted just before halting cannot be missed.
+ *
+ * @param ev The address to which the event will be written
+ *
+ * @return Void
+ */
+void wait_event(event *ev) {
+	while(!get_event(ev)) {
+		disable_interrupts();
+		if(event_head == event_tail) {
+			ENABLE_INTERRUPTS_AND_HALT();
+		} else {
+			enable_interrupts();
+		}
+	}
+}
+
+/**
+ * @brief Function to get the number of events dropped so far
+ * because the queue was full.
+ *
+ * @return Number of events dropped
+ */
+unsigned int events_dropped() {
+	return dropped_events;
+}
@@ -0,0 +1,33 @@
+/** @file console_driver.h
+ *
+ *	@brief Interface for the console driver functions which are
+ *	not part of the p1kern.h specification
+ *
+ *	@author Prajwal Yadapadithaya (pyadapad)
+ *	@bug None
+ **/
+
+#ifndef __console_driver_h
+#define __console_driver_h
+
+#include <stdint.h>
+
+/*Packs a character and its color into a cell, as stored in video memory*/
+#define CONSOLE_CELL(ch, color) \
+	((uint16_t)((((color)&0xFF)<<8) | ((ch)&0xFF)))
+
+void console_set_buffered(int);
+
+void console_flush(void);
+
+void console_scroll_view(int);
+
+int draw_rect(int, int, int, int, int, int);
+
+int blit_cells(int, int, int, int, const uint16_t *);
+
+int set_attr_rect(int, int, int, int, int);
+
+unsigned int console_port_writes(void);
+
+#endif
@@ -0,0 +1,33 @@
+/** @file event_queue.h
+ *
+ *	@brief Interface for the event queue shared by the interrupt
+ *	handlers and the main loop
+ *
+ *	@author Prajwal Yadapadithaya (pyadapad)
+ *	@bug None
+ **/
+
+#ifndef __event_queue_h
+#define __event_queue_h
+
+/*Types of events*/
+enum event_type {
+	EVENT_KEY, /*Scancodes are waiting to be read with readchar()*/
+	EVENT_TIMER /*A software timer expired, with the data it posted*/
+};
+
+/*An event posted by an interrupt handler*/
+typedef struct event {
+	enum event_type type;
+	unsigned int data;
+} event;
+
+int post_event(enum event_type, unsigned int);
+
+int get_event(event *);
+
+void wait_event(event *);
+
+unsigned int events_dropped(void);
+
+#endif
@@ -1,25 +1,28 @@
 /** @file timer_driver.h
  *
- *	@brief Interface for handlers of keyboard and timer
+ *	@brief Interface for the entry stubs of the hardware interrupts,
+ *	and helpers for code shared with interrupt handlers
  *
  *	@author Prajwal Yadapadithaya (pyadapad)
  *	@bug None
  **/
 
-/**
- * @brief Interrupt handler for timer interrupts. The handler
- * saves the registers and handles control to the C timer 
- * driver function
- *
- * @return Void
- */
-void timer_handler(void);
+#ifndef __handler_helper_h
+#define __handler_helper_h
+
+/*Keeps the compiler from moving memory accesses across it*/
+#define COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/*Enables interrupts and halts until the next one. No interrupt can
+  be taken between the two instructions*/
+#define ENABLE_INTERRUPTS_AND_HALT() \
+	__asm__ __volatile__("sti; hlt" ::: "memory")
 
 /**
- * @brief Interrupt handler for keyboard interrupts. The handler
- * saves the registers and handles control to the C keyboard
- * driver function
- *
- * @return Void
+ * Entry stubs of the hardware interrupts, indexed by PIC line
+ * (0 to IRQ_COUNT-1). Each stub saves the registers and hands
+ * control to irq_dispatch() with its line.
  */
-void keyboard_handler(void);
+extern void *irq_stubs[];
+
+#endif
@@ -0,0 +1,57 @@
+/** @file irq.h
+ *
+ *	@brief Interface for the dispatch of hardware interrupts
+ *
+ *	@author Prajwal Yadapadithaya (pyadapad)
+ *	@bug None
+ **/
+
+#ifndef __irq_h
+#define __irq_h
+
+/*Number of interrupt lines of the two PICs*/
+#define IRQ_COUNT 16
+
+/*Interrupt lines of the devices*/
+#define TIMER_IRQ 0
+#define KEYBOARD_IRQ 1
+
+/*If IRQ_PROFILE is defined, the entry stubs time every interrupt with
+  rdtsc, and the durations and arrival times are recorded by
+  irq_profile_record(). It is off by default, and turned on with
+  IRQ_PROFILE = 1 in config.mk*/
+
+#ifndef ASSEMBLER
+
+#include <stdint.h>
+
+/**
+ * Statistics of an interrupt line.
+ */
+typedef struct irq_stats {
+	unsigned int count; /*Interrupts handled*/
+	unsigned int spurious; /*Spurious interrupts, which were ignored*/
+	uint64_t total_cycles; /*Cycles spent in the handler*/
+	uint64_t max_cycles; /*Most cycles spent on one interrupt*/
+	unsigned int bh_runs; /*Runs of the bottom half*/
+	unsigned int bh_deferred; /*Interrupts whose bottom half was left
+								to a run already in progress*/
+	uint64_t bh_max_cycles; /*Most cycles spent on one run of the
+							  bottom half*/
+} irq_stats;
+
+int irq_register(unsigned int, void (*)(void));
+
+int irq_register_bottom_half(unsigned int, void (*)(void));
+
+void irq_dispatch(unsigned int);
+
+int irq_get_stats(unsigned int, irq_stats *);
+
+void irq_profile_record(unsigned int, uint64_t, uint64_t);
+
+void irq_profile_dump(void);
+
+#endif /* ASSEMBLER */
+
+#endif
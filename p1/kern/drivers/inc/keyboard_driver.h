@@ -9,6 +9,16 @@
 #ifndef __keyboard_driver_h
 #define __keyboard_driver_h
 
+#include <stdint.h>
+
 void add_to_keyboard_buffer();
 
+int readchar_wait(void);
+
+int readchar_timeout(unsigned int);
+
+unsigned int keyboard_dropped_keys(void);
+
+void keyboard_latency(unsigned int *, uint64_t *, uint64_t *);
+
 #endif
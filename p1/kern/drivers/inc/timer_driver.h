@@ -9,8 +9,36 @@
 #ifndef __timer_driver_h
 #define __timer_driver_h
 
+#include <stdint.h>
+
+/*Range of the PIT divisor. The PIT input clock runs at TIMER_RATE Hz*/
+#define TIMER_MIN_DIVISOR 2
+#define TIMER_MAX_DIVISOR 65535
+
 void timer_tick(void);
 
 void initialize_callback(void *);
 
+unsigned int timer_ticks(void);
+
+void timer_set_tickless(int);
+
+void timer_set_deferred(int);
+
+void timer_deadline_changed(void);
+
+int timer_set_divisor(unsigned int);
+
+int timer_set_rate(unsigned int);
+
+unsigned int timer_ms_to_ticks(unsigned int);
+
+unsigned int timer_get_divisor(void);
+
+uint64_t timer_ns(void);
+
+uint64_t timer_tsc_hz(void);
+
+uint64_t timer_cycles_to_ns(uint64_t);
+
 #endif
@@ -0,0 +1,47 @@
+/** @file timer_wheel.h
+ *
+ *	@brief Interface for the software timers run by the timer driver
+ *
+ *	@author Prajwal Yadapadithaya (pyadapad)
+ *	@bug None
+ **/
+
+#ifndef __timer_wheel_h
+#define __timer_wheel_h
+
+/*Longest delay, in ticks, a timer can be started with. Longer delays
+  are shortened to this*/
+#define SOFT_TIMER_MAX_DELAY ((1u << 24) - 1)
+
+/*Returned by soft_timer_next() when no timer is pending*/
+#define SOFT_TIMER_NONE 0xFFFFFFFFu
+
+/**
+ * A software timer. The memory is owned by the caller, and must stay
+ * valid while the timer is pending. The fields are private to
+ * timer_wheel.c, and are set up with soft_timer_init().
+ */
+typedef struct soft_timer {
+	struct soft_timer *next;
+	struct soft_timer **pprev; /*NULL when the timer is not pending*/
+	unsigned int expires; /*Tick at which the timer expires*/
+	unsigned int period; /*Ticks between expiries, 0 for one-shot*/
+	void (*func)(void *); /*Called in interrupt context on expiry*/
+	void *arg;
+} soft_timer;
+
+void soft_timer_init(soft_timer *, void (*)(void *), void *);
+
+int soft_timer_start(soft_timer *, unsigned int, unsigned int);
+
+int soft_timer_cancel(soft_timer *);
+
+int soft_timer_pending(soft_timer *);
+
+void soft_timer_tick(void);
+
+void soft_timer_advance(unsigned int);
+
+unsigned int soft_timer_next(void);
+
+#endif
@@ -1,8 +1,8 @@
 /** @file install_driver.c
  *
  *  @brief Implementation of the handler_install function.
- *  Installs handlers for console, keyboard and timer
- *  interrupt handlers.
+ *  Installs the entry stubs of all the hardware interrupts,
+ *  and registers the keyboard and timer interrupt handlers.
  *
  *  @author Prajwal Yadapadithaya (pyadapad)
  *  @bug None
@@ -20,6 +20,8 @@
 #include <interrupt_defines.h>
 
 #include "inc/handler_helper.h"
+#include "inc/irq.h"
+#include "inc/keyboard_driver.h"
 #include "inc/timer_driver.h"
 
 /*IDT ENTRY CONSTANTS*/
@@ -35,17 +37,17 @@
 /*IDT ENTRY VALUES*/
 #define RESERVED_VAL 0
 #define ZEROES_VAL 0
-#define SIZE_VAL 15
+/*32 bit interrupt gate. Unlike a trap gate (15), it clears IF on entry,
+  so the handlers run with interrupts disabled, and IRET restores IF*/
+#define SIZE_VAL 14
 #define DPL_VAL 0
 #define P_VAL 1
 
 /*TIMER CONSTANTS*/
-#define CPU_RATE 1193182
 #define TIMER_PERIOD 100
-#define LS_BYTE(x) ((x)&0xFF)
-#define MS_BYTE(x) (((x)>>8)&0xFF)
 
 /*OTHER CONSTANTS*/
+#define IRQS_PER_PIC 8
 #define IDT_ENRTY_LENGTH 8
 
 /**
@@ -66,10 +68,12 @@ struct idt_entry {
 static void populate_idt_entry(struct idt_entry *, void *);
 static void initialize_timer_frequency(void);
 static int add_idt_entry(int, void *);
+static int irq_vector(int);
 
 /**
- * @brief Configures the keyboard and the timer handers
- * by adding an entry in the IDT.
+ * @brief Adds an entry in the IDT for the entry stub of every
+ * interrupt line, and registers the keyboard and the timer
+ * handlers with the interrupt dispatcher.
  *
  * @param tickback Function pointer of the callback function
  * that needs to be called by the timer driver.
@@ -79,10 +83,11 @@ static int add_idt_entry(int, void *);
  */
 int handler_install(void (*tickback)(unsigned int)) {
 
-	int ret1, ret2;
+	int ret = 0;
+	int irq;
 
 	/*Keyboard driver initialization*/
-	ret1 = add_idt_entry(KEY_IDT_ENTRY, keyboard_handler);
+	ret |= irq_register(KEYBOARD_IRQ, add_to_keyboard_buffer);
 
 	/*Timer driver initialization*/
 	initialize_callback(tickback);	
@@ -90,10 +95,14 @@ int handler_install(void (*tickback)(unsigned int)) {
 	//Initialize timer frequency
 	initialize_timer_frequency();
 
-	//Create an IDT entry for timer driver
-	ret2 = add_idt_entry(TIMER_IDT_ENTRY, timer_handler);
+	ret |= irq_register(TIMER_IRQ, timer_tick);
 
-	if(ret1==0 && ret2==0) {
+	//Create an IDT entry for every interrupt line
+	for(irq = 0; irq < IRQ_COUNT; irq++) {
+		ret |= add_idt_entry(irq_vector(irq), irq_stubs[irq]);
+	}
+
+	if(ret == 0) {
 		return 0;
 	}
 	return -1;
@@ -102,14 +111,27 @@ int handler_install(void (*tickback)(unsigned int)) {
 
 /**
  * @brief Initializes the timer frequency to generate interrupts
- * every 10 milliseconds
+ * every 10 milliseconds. The rate can be changed later with
+ * timer_set_rate() or timer_set_divisor().
  * @return Void
  */
 void initialize_timer_frequency() {
-	outb(TIMER_MODE_IO_PORT, TIMER_SQUARE_WAVE);
-	unsigned short rate = CPU_RATE/TIMER_PERIOD;
-	outb(TIMER_PERIOD_IO_PORT, LS_BYTE(rate));
-	outb(TIMER_PERIOD_IO_PORT, MS_BYTE(rate));
+	timer_set_rate(TIMER_PERIOD);
+}
+
+/**
+ * @brief Function to get the IDT entry which an interrupt
+ * line of the PICs is delivered to.
+ *
+ * @param irq The interrupt line
+ *
+ * @return Index of the IDT entry
+ */
+int irq_vector(int irq) {
+	if(irq < IRQS_PER_PIC) {
+		return X86_PIC_MASTER_IRQ_BASE + irq;
+	}
+	return X86_PIC_SLAVE_IRQ_BASE + (irq - IRQS_PER_PIC);
 }
 
 /**
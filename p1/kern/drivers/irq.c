@@ -0,0 +1,395 @@
+/** @file irq.c
+ *
+ *  @brief Dispatch of hardware interrupts. The entry stub of every
+ *  PIC line (handler_helper.S) calls irq_dispatch() with its line,
+ *  which calls the C handler registered for the line, acknowledges
+ *  the interrupt to the PIC, and keeps statistics of the line.
+ *  Drivers only register their handlers with irq_register(), and
+ *  do not talk to the PIC themselves.
+ *
+ *  A line can also have a bottom half, for work which does not need
+ *  to be done with interrupts disabled. The bottom half is run after
+ *  the interrupt is acknowledged, with interrupts enabled, so other
+ *  interrupts (including the same line) can nest in it. It is never
+ *  run twice at the same time: an interrupt which arrives while it
+ *  runs makes it run once more instead.
+ *
+ *  With IRQ_PROFILE, the stubs also time every interrupt, from entry
+ *  to the return of irq_dispatch(). For every line, the durations are
+ *  kept as min/avg/max and a histogram, along with the intervals
+ *  between interrupts and their jitter. irq_profile_dump() writes
+ *  them to the Simics console.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <p1kern.h>
+#include <stddef.h>
+#include <simics.h>
+#include <asm.h>
+#include <eflags.h>
+#include <interrupt_defines.h>
+
+#include "inc/irq.h"
+#include "inc/timer_driver.h"
+
+/*Reads the in-service register of a PIC*/
+#define PIC_READ_ISR 0x0B
+
+/*Lowest priority line of each PIC. The PICs raise these lines for
+  spurious interrupts*/
+#define MASTER_SPURIOUS_IRQ 7
+#define SLAVE_SPURIOUS_IRQ 15
+#define SPURIOUS_IRQ_BIT 0x80
+
+/*Line of the master PIC which the slave PIC is connected to*/
+#define CASCADE_IRQ 2
+
+/*Buckets of the duration histogram. Bucket n counts durations of
+  2^n to 2^(n+1)-1 cycles; the last one also counts longer ones*/
+#define PROFILE_BUCKETS 24
+
+/**
+ * Profile of an interrupt line, recorded by the entry stub.
+ */
+typedef struct irq_profile {
+	unsigned int count; /*Interrupts timed*/
+	uint64_t min_cycles; /*Durations, from entry to the return*/
+	uint64_t max_cycles; /*of irq_dispatch()*/
+	uint64_t total_cycles;
+	unsigned int histogram[PROFILE_BUCKETS];
+	uint64_t last_start; /*TSC at the entry of the last interrupt*/
+	unsigned int intervals; /*Intervals between entries recorded*/
+	uint64_t last_interval; /*Cycles between the last two entries*/
+	uint64_t min_interval;
+	uint64_t max_interval;
+	uint64_t total_interval;
+	uint64_t total_jitter; /*Sum of the differences between consecutive
+							 intervals*/
+} irq_profile;
+
+void (*irq_handlers[IRQ_COUNT])(void);
+void (*irq_bottom_halves[IRQ_COUNT])(void);
+irq_stats irq_table_stats[IRQ_COUNT];
+
+/*State of the bottom halves, only changed with interrupts disabled*/
+int bh_running[IRQ_COUNT]; /*1 while the bottom half runs*/
+int bh_pending[IRQ_COUNT]; /*1 if it has to run again*/
+irq_profile irq_profiles[IRQ_COUNT];
+
+/*Helper functions*/
+static int is_spurious(unsigned int);
+static void run_bottom_half(unsigned int);
+static int histogram_bucket(uint64_t);
+#ifdef IRQ_PROFILE
+static void dump_profile(unsigned int, irq_profile *);
+#endif
+
+/**
+ * @brief Function to register the handler of an interrupt line.
+ * The handler is called with interrupts disabled, and must not
+ * acknowledge the interrupt to the PIC.
+ *
+ * @param irq The interrupt line, from 0 to IRQ_COUNT-1
+ * @param handler The handler, or NULL to remove the current one
+ *
+ * @return 0 if successful, -1 if the line is out of range
+ */
+int irq_register(unsigned int irq, void (*handler)(void)) {
+	if(irq >= IRQ_COUNT) {
+		return -1;
+	}
+
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+	irq_handlers[irq] = handler;
+	set_eflags(eflags);
+
+	return 0;
+}
+
+/**
+ * @brief Function to register the bottom half of an interrupt line.
+ * The bottom half is run after every interrupt of the line, once the
+ * handler has returned and the interrupt has been acknowledged, with
+ * interrupts enabled. It returns with interrupts enabled.
+ *
+ * @param irq The interrupt line, from 0 to IRQ_COUNT-1
+ * @param bottom_half The bottom half, or NULL to remove the current one
+ *
+ * @return 0 if successful, -1 if the line is out of range
+ */
+int irq_register_bottom_half(unsigned int irq, void (*bottom_half)(void)) {
+	if(irq >= IRQ_COUNT) {
+		return -1;
+	}
+
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+	irq_bottom_halves[irq] = bottom_half;
+	set_eflags(eflags);
+
+	return 0;
+}
+
+/**
+ * @brief Function called by the entry stubs of the interrupt
+ * lines. Calls the handler of the line, if any, acknowledges
+ * the interrupt, and runs the bottom half of the line, if any.
+ * Spurious interrupts are counted, and not acknowledged to the
+ * PIC which raised them. The lines have interrupt gates in the
+ * IDT, so this is called, and returns, with interrupts disabled.
+ *
+ * @param irq The interrupt line
+ *
+ * @return Void
+ */
+void irq_dispatch(unsigned int irq) {
+	irq_stats *stats = &irq_table_stats[irq];
+
+	if(is_spurious(irq)) {
+		stats->spurious++;
+		if(irq == SLAVE_SPURIOUS_IRQ) {
+			/*The master did see an interrupt on the cascade line*/
+			pic_acknowledge(CASCADE_IRQ);
+		}
+		return;
+	}
+
+	uint64_t start = rdtsc();
+	if(irq_handlers[irq] != NULL) {
+		irq_handlers[irq]();
+	}
+	uint64_t cycles = rdtsc() - start;
+
+	stats->count++;
+	stats->total_cycles += cycles;
+	if(cycles > stats->max_cycles) {
+		stats->max_cycles = cycles;
+	}
+
+	pic_acknowledge(irq);
+
+	if(irq_bottom_halves[irq] != NULL) {
+		run_bottom_half(irq);
+	}
+}
+
+/**
+ * @brief Function to run the bottom half of a line, with interrupts
+ * enabled, unless it is already running further down the stack. In
+ * that case, the running one is asked to run again when it is done.
+ * Called and returns with interrupts disabled.
+ *
+ * @param irq The interrupt line
+ *
+ * @return Void
+ */
+void run_bottom_half(unsigned int irq) {
+	irq_stats *stats = &irq_table_stats[irq];
+
+	if(bh_running[irq]) {
+		bh_pending[irq] = 1;
+		stats->bh_deferred++;
+		return;
+	}
+
+	bh_running[irq] = 1;
+	do {
+		bh_pending[irq] = 0;
+
+		uint64_t start = rdtsc();
+		enable_interrupts();
+		irq_bottom_halves[irq]();
+		disable_interrupts();
+		uint64_t cycles = rdtsc() - start;
+
+		stats->bh_runs++;
+		if(cycles > stats->bh_max_cycles) {
+			stats->bh_max_cycles = cycles;
+		}
+	} while(bh_pending[irq]);
+	bh_running[irq] = 0;
+}
+
+/**
+ * @brief Function to get the statistics of an interrupt line.
+ *
+ * @param irq The interrupt line
+ * @param stats The address to which the statistics will be written
+ *
+ * @return 0 if successful, -1 if the line is out of range
+ */
+int irq_get_stats(unsigned int irq, irq_stats *stats) {
+	if(irq >= IRQ_COUNT) {
+		return -1;
+	}
+
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+	*stats = irq_table_stats[irq];
+	set_eflags(eflags);
+
+	return 0;
+}
+
+/**
+ * @brief Function called by the entry stubs, when IRQ_PROFILE is
+ * defined, after irq_dispatch() returns. Records the duration of the
+ * interrupt, and the time since the previous one on the same line.
+ *
+ * @param irq The interrupt line
+ * @param end TSC after irq_dispatch() returned
+ * @param start TSC at the entry of the stub
+ *
+ * @return Void
+ */
+void irq_profile_record(unsigned int irq, uint64_t end, uint64_t start) {
+	irq_profile *prof = &irq_profiles[irq];
+	uint64_t cycles = end - start;
+
+	if(prof->count == 0 || cycles < prof->min_cycles) {
+		prof->min_cycles = cycles;
+	}
+	if(cycles > prof->max_cycles) {
+		prof->max_cycles = cycles;
+	}
+	prof->total_cycles += cycles;
+	prof->histogram[histogram_bucket(cycles)]++;
+
+	/*An interrupt which nested in a bottom half of the line is recorded
+	  before the one it nested in, whose interval is not recorded*/
+	if(prof->count != 0 && start > prof->last_start) {
+		uint64_t interval = start - prof->last_start;
+		if(prof->intervals == 0 || interval < prof->min_interval) {
+			prof->min_interval = interval;
+		}
+		if(interval > prof->max_interval) {
+			prof->max_interval = interval;
+		}
+		prof->total_interval += interval;
+		if(prof->intervals != 0) {
+			prof->total_jitter += (interval > prof->last_interval) ?
+				interval - prof->last_interval :
+				prof->last_interval - interval;
+		}
+		prof->last_interval = interval;
+		prof->intervals++;
+	}
+	if(start > prof->last_start) {
+		prof->last_start = start;
+	}
+	prof->count++;
+}
+
+/**
+ * @brief Function to write the profile of every interrupt line
+ * which has had interrupts to the Simics console. Times are in
+ * cycles, and in microseconds once the TSC rate is calibrated.
+ *
+ * @return Void
+ */
+void irq_profile_dump() {
+#ifdef IRQ_PROFILE
+	unsigned int irq;
+	irq_profile prof;
+
+	lprintf("Interrupt profile (TSC at %u kHz)",
+			(unsigned int)(timer_tsc_hz()/1000));
+	for(irq = 0; irq < IRQ_COUNT; irq++) {
+		uint32_t eflags = get_eflags();
+		disable_interrupts();
+		prof = irq_profiles[irq];
+		set_eflags(eflags);
+
+		if(prof.count != 0) {
+			dump_profile(irq, &prof);
+		}
+	}
+#else
+	lprintf("Interrupt profile not recorded, IRQ_PROFILE is not defined");
+#endif
+}
+
+#ifdef IRQ_PROFILE
+/**
+ * @brief Function to write the profile of one interrupt line to
+ * the Simics console.
+ *
+ * @param irq The interrupt line
+ * @param prof A copy of the profile of the line
+ *
+ * @return Void
+ */
+void dump_profile(unsigned int irq, irq_profile *prof) {
+	unsigned int avg = prof->total_cycles/prof->count;
+	int i;
+
+	lprintf("IRQ %u: %u interrupts", irq, prof->count);
+	lprintf("  duration: min %u avg %u max %u cycles "
+			"(avg %u us, max %u us)",
+			(unsigned int)prof->min_cycles, avg,
+			(unsigned int)prof->max_cycles,
+			(unsigned int)(timer_cycles_to_ns(avg)/1000),
+			(unsigned int)(timer_cycles_to_ns(prof->max_cycles)/1000));
+
+	if(prof->intervals > 0) {
+		uint64_t avg_interval = prof->total_interval/prof->intervals;
+		lprintf("  interval: min %u avg %u max %u us",
+				(unsigned int)(timer_cycles_to_ns(prof->min_interval)/1000),
+				(unsigned int)(timer_cycles_to_ns(avg_interval)/1000),
+				(unsigned int)(timer_cycles_to_ns(prof->max_interval)/1000));
+	}
+	if(prof->intervals > 1) {
+		uint64_t avg_jitter = prof->total_jitter/(prof->intervals - 1);
+		lprintf("  jitter: avg %u cycles (%u us)", (unsigned int)avg_jitter,
+				(unsigned int)(timer_cycles_to_ns(avg_jitter)/1000));
+	}
+
+	for(i = 0; i < PROFILE_BUCKETS; i++) {
+		if(prof->histogram[i] != 0) {
+			lprintf("  %u-%u cycles: %u", 1u << i, (2u << i) - 1,
+					prof->histogram[i]);
+		}
+	}
+}
+#endif
+
+/**
+ * @brief Function to find the histogram bucket of a duration,
+ * which is the position of its highest set bit.
+ *
+ * @param cycles The duration
+ *
+ * @return Index of the bucket
+ */
+int histogram_bucket(uint64_t cycles) {
+	int bucket = 0;
+	while(cycles > 1 && bucket < PROFILE_BUCKETS-1) {
+		cycles >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+/**
+ * @brief Function to check if an interrupt on the lowest priority
+ * line of a PIC is spurious, which is the case if the PIC does not
+ * have it in service.
+ *
+ * @param irq The interrupt line
+ *
+ * @return 1 if the interrupt is spurious, 0 if not
+ */
+int is_spurious(unsigned int irq) {
+	if(irq == MASTER_SPURIOUS_IRQ) {
+		outb(MASTER_ICW, PIC_READ_ISR);
+		return (inb(MASTER_ICW) & SPURIOUS_IRQ_BIT) == 0;
+	}
+	if(irq == SLAVE_SPURIOUS_IRQ) {
+		outb(SLAVE_ICW, PIC_READ_ISR);
+		return (inb(SLAVE_ICW) & SPURIOUS_IRQ_BIT) == 0;
+	}
+	return 0;
+}
@@ -1,9 +1,11 @@
 /** @file keyboard_driver.c
  *
  *  @brief The keyboard device driver code. The keyboard driver
- *  stores the processed scancodes received in a queue implemented
- *  using a doubly linked list. When a readchar request comes, the
- *  head of the queue is removed until a valid character is obtained.
+ *  stores the raw scancodes received in a fixed size ring buffer,
+ *  filled by the interrupt handler and drained by readchar(). When
+ *  a readchar request comes, scancodes are removed from the ring and
+ *  processed until a valid character is obtained, so that the
+ *  interrupt handler does as little as possible.
  *
  *  @author Prajwal Yadapadithaya (pyadapad)
  *  @bug
@@ -11,143 +13,280 @@
 
 #include <p1kern.h>
 #include <stdio.h>
-#include <stdlib.h>
 #include <simics.h>
 #include <keyhelp.h>
 #include <asm.h>
 #include <interrupt_defines.h>
 
+#include "inc/console_driver.h"
+#include "inc/keyboard_driver.h"
+#include "inc/timer_driver.h"
+#include "inc/timer_wheel.h"
+#include "inc/handler_helper.h"
+#include "inc/event_queue.h"
+
+#define SCROLLBACK_PAGE (CONSOLE_HEIGHT-1)
+
+/*Size of the keyboard buffer. Must be a power of two*/
+#define KEY_BUFFER_SIZE 256
+#define KEY_BUFFER_MASK (KEY_BUFFER_SIZE-1)
+
 /**
- * Struct to store the keyboard buffer. The data structure used
- * is a queue implemented using a doubly linked list. Each time
- * a 
+ * Keyboard buffer of raw scancodes. The buffer is a ring with a single
+ * producer, the keyboard interrupt handler, and a single consumer,
+ * readchar(). The indices run freely and are masked when used, so the
+ * ring is empty when they are equal and full when they are
+ * KEY_BUFFER_SIZE apart. Each index is written only by its own side.
+ * The TSC at which each key arrived is kept alongside it, to measure
+ * how long keys wait before readchar() gets to them.
  */
-typedef struct key {
-	kh_type ch;
-	struct key *next;
-	struct key *prev;
-}key;
+uint8_t key_buffer[KEY_BUFFER_SIZE];
+uint64_t key_stamps[KEY_BUFFER_SIZE];
+volatile unsigned int key_head = 0; /*Next key to be read, by readchar()*/
+volatile unsigned int key_tail = 0; /*Next free slot, for the handler*/
+volatile unsigned int keys_dropped = 0; /*Keys lost because the ring was full*/
 
-key *head = NULL; /*Head of the queue*/
-key *tail = NULL; /*Tail of the queue*/
+/*Time keys spent in the ring, in cycles. Written only by readchar()*/
+unsigned int latency_count = 0;
+uint64_t latency_cycles = 0;
+uint64_t latency_max_cycles = 0;
 
 /*Helper functions*/
-static void add_key_to_queue(kh_type);
+static int dequeue(uint8_t *, uint64_t *);
+static void add_key_to_queue(uint8_t);
 static int read_scancode();
-static void notify_pic();
+static int handle_scrollback_key(kh_type);
+static void wait_for_interrupt(void);
+static void timeout_expired(void *);
 
 /**
- * @brief Function to get the first element in the queue
- * Removes the first element from the queue, and updates
- * the head of the queue.
+ * @brief Function to remove the first scancode from the keyboard
+ * buffer. Called only by readchar().
  *
- * @return key First key in the queue. NULL if there are no
- * keys in the queue.
+ * @param ch The address to which the scancode will be written
+ *
+ * @return 1 if a scancode was removed, 0 if the buffer is empty.
  */
-key *dequeue() {
-	if(head == NULL) {
-		return NULL;
+int dequeue(uint8_t *ch, uint64_t *stamp) {
+	unsigned int head = key_head;
+	if(head == key_tail) {
+		return 0;
 	}
 
-	key *first = head;
-	head = head->next;
+	*ch = key_buffer[head & KEY_BUFFER_MASK];
+	*stamp = key_stamps[head & KEY_BUFFER_MASK];
+	COMPILER_BARRIER(); /*Read the key before giving the slot back*/
+	key_head = head + 1;
+	return 1;
+}
 
-	if(head != NULL) {
-		head->prev = NULL;
-	} else {
-		tail = NULL;
-	}
+/**
+ * @brief Function to read a scancode from keyboard and
+ * add it to the keyboard buffer. The scancode is processed
+ * later, by readchar(), and a key event is posted to tell the
+ * consumer about it. Registered as the handler of KEYBOARD_IRQ,
+ * which acknowledges the interrupt.
+ *
+ * @return Void
+ *
+ */
+void add_to_keyboard_buffer() {
+	add_key_to_queue((uint8_t)read_scancode());
+	post_event(EVENT_KEY, 0);
+}
 
-	first->next = NULL;
-	return first;
+/**
+ * @brief Reads a scancode from keyboard
+ * 
+ * @return int the value of the scancode
+ */
+int read_scancode() {
+	return (int)inb(KEYBOARD_PORT);
 }
 
 /**
- * @brief Function to add a new key to the end of the queue.
- * Updates the end of the queue with the new key.
+ * @brief Function to add a scancode to the end of the keyboard
+ * buffer. Called only by the interrupt handler. If the buffer
+ * is full, the scancode is dropped and counted.
  *
  * @return Void
  */
-void enqueue(key *key) {
-	if(head == NULL) {
-		head = key;
-		tail = key;
+void add_key_to_queue(uint8_t ch) {
+	unsigned int tail = key_tail;
+	if(tail - key_head == KEY_BUFFER_SIZE) {
+		keys_dropped++;
 		return;
 	}
-	tail->next = key;
-	key->prev = tail;
-	tail = key;
-	tail->next = NULL;
+
+	key_buffer[tail & KEY_BUFFER_MASK] = ch;
+	key_stamps[tail & KEY_BUFFER_MASK] = rdtsc();
+	COMPILER_BARRIER(); /*Write the key before publishing it*/
+	key_tail = tail + 1;
 }
 
 
 /**
- * @brief Function to read and process a scancode
- * from keyboard
+ * @brief Function to return the next character in the keyboard
+ * buffer. If there are no keys, the function does not block.
+ * Scancodes are processed here rather than in the interrupt
+ * handler. Keys used to scroll the console back are handled
+ * here, and are not returned.
  *
- * @return Void
+ * @return int Next character in the keyboard buffer. If there
+ * are no characters present, -1 is returned.
+ */
+int readchar() {
+	uint8_t scancode;
+	uint64_t stamp;
+	while(dequeue(&scancode, &stamp)) {
+		uint64_t latency = rdtsc() - stamp;
+		latency_count++;
+		latency_cycles += latency;
+		if(latency > latency_max_cycles) {
+			latency_max_cycles = latency;
+		}
+
+		kh_type ch = process_scancode(scancode);
+		if(KH_HASDATA(ch) && !KH_ISMAKE(ch) && 
+				!handle_scrollback_key(ch)) {
+			return KH_GETCHAR(ch);
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Function to return the next character in the keyboard
+ * buffer, blocking until there is one. While the buffer is empty,
+ * the CPU is halted until the next interrupt.
  *
+ * @return int Next character in the keyboard buffer.
  */
-void add_to_keyboard_buffer() {
-	int scancode = read_scancode();
-	kh_type ch = process_scancode(scancode);
-	add_key_to_queue(ch);
-	notify_pic();
+int readchar_wait() {
+	int ch;
+	while((ch = readchar()) == -1) {
+		wait_for_interrupt();
+	}
+	return ch;
 }
 
 /**
- * @brief Reads a scancode from keyboard
- * 
- * @return int the value of the scancode
+ * @brief Function to return the next character in the keyboard
+ * buffer, blocking until there is one or until the given number of
+ * timer ticks have passed. While the buffer is empty, the CPU is
+ * halted until the next interrupt. A software timer makes sure there
+ * is an interrupt when the time is up, even if the timer is tickless.
+ *
+ * @param ticks Maximum number of timer ticks to wait for
+ *
+ * @return int Next character in the keyboard buffer, -1 if no
+ * character arrived in time.
  */
-int read_scancode() {
-	return (int)inb(KEYBOARD_PORT);
+int readchar_timeout(unsigned int ticks) {
+	int ch;
+	soft_timer timeout;
+	unsigned int start = timer_ticks();
+
+	soft_timer_init(&timeout, timeout_expired, NULL);
+	soft_timer_start(&timeout, ticks, 0);
+	while((ch = readchar()) == -1) {
+		if(timer_ticks() - start >= ticks) {
+			break;
+		}
+		wait_for_interrupt();
+	}
+	soft_timer_cancel(&timeout);
+	return ch;
 }
 
 /**
- * @brief Function to create an entry in the queue
- * and enqueue it, for a given character.
+ * @brief Function called when the timeout of readchar_timeout()
+ * expires. Nothing needs to be done, as the timer interrupt
+ * itself wakes up the waiting CPU.
+ *
+ * @param arg Unused
  *
  * @return Void
  */
-void add_key_to_queue(kh_type ch) {
-	key *entry = (key *)malloc(sizeof(key));
-	entry->ch = ch;
-	entry->next = NULL;
-	entry->prev = NULL;
-	enqueue(entry);
+void timeout_expired(void *arg) {
 }
 
 /**
- * @brief Function to notify the PIC that the scancode
- * has been processed.
+ * @brief Function to halt the CPU until the next interrupt, unless
+ * the keyboard buffer is not empty. The check is made with interrupts
+ * disabled, so a key arriving just before halting cannot be missed.
+ * Returns with interrupts enabled.
  *
  * @return Void
  */
-void notify_pic() {
-	outb(INT_CTL_PORT, INT_ACK_CURRENT);
+void wait_for_interrupt() {
+	disable_interrupts();
+	if(key_head == key_tail) {
+		ENABLE_INTERRUPTS_AND_HALT();
+	} else {
+		enable_interrupts();
+	}
 }
 
 /**
- * @brief Function to return the next character in the keyboard
- * buffer. If there are no keys, the function does not block.
+ * @brief Function to get the number of keys dropped so far
+ * because the keyboard buffer was full.
  *
- * @return int Next character in the keyboard buffer. If there
- * are no characters present, -1 is returned.
+ * @return Number of keys dropped
  */
-int readchar() {
-	key *first;
-	while(((first=dequeue()) != NULL) && 
-			((!KH_HASDATA(first->ch)) ||
-			(KH_ISMAKE(first->ch)))) {
-		free(first); /*We don't need this anymore*/
-	}
+unsigned int keyboard_dropped_keys() {
+	return keys_dropped;
+}
+
+/**
+ * @brief Function to get the time keys have waited in the keyboard
+ * buffer, from the interrupt handler to readchar(). Must be called
+ * from the same thread as readchar().
+ *
+ * @param count The address to which the number of keys read will
+ * be written
+ * @param total The address to which the total number of cycles
+ * will be written
+ * @param max The address to which the largest number of cycles
+ * a key waited will be written
+ *
+ * @return Void
+ */
+void keyboard_latency(unsigned int *count, uint64_t *total,
+						uint64_t *max) {
+	*count = latency_count;
+	*total = latency_cycles;
+	*max = latency_max_cycles;
+}
 
-	if(first != NULL) {
-		char c = first->ch;
-		free(first);
-		return KH_GETCHAR(c);
+/**
+ * @brief Function to scroll the console view back and forth
+ * through its history. Shift+Up and Shift+Down scroll by a row,
+ * Ctrl+Up and Ctrl+Down scroll by a page.
+ *
+ * @param ch The processed key
+ *
+ * @return 1 if the key was used for scrolling, 0 if not.
+ */
+int handle_scrollback_key(kh_type ch) {
+	int rows;
+	if(KH_SHIFT(ch)) {
+		rows = 1;
+	} else if(KH_CTL(ch)) {
+		rows = SCROLLBACK_PAGE;
+	} else {
+		return 0;
 	}
 
-	return -1;
+	switch(KH_GETCHAR(ch)) {
+		case KHE_ARROW_UP:
+			console_scroll_view(rows);
+			return 1;
+		case KHE_ARROW_DOWN:
+			console_scroll_view(-rows);
+			return 1;
+		default:
+			return 0;
+	}
 }
@@ -5,6 +5,27 @@
  *  received, calls the callback function with the current
  *  tickcount
  *
+ *  The driver also programs the rate of the PIT, and keeps a
+ *  monotonic clock in nanoseconds. The clock counts the PIT input
+ *  clock periods of all the ticks so far, plus the part of the
+ *  current tick read from the PIT's counter latch. The rate of the
+ *  time stamp counter is calibrated against the PIT, so that cycle
+ *  counts read with rdtsc() can be converted to nanoseconds too.
+ *
+ *  In tickless mode, the PIT is not programmed to interrupt on every
+ *  tick. Instead, it is programmed in one-shot mode for the next tick
+ *  on which a software timer has work to do, or as far as its 16 bit
+ *  counter allows (about 55ms). On every interrupt, the ticks which
+ *  have passed are worked out from the clock and run at once.
+ *
+ *  In deferred mode, the interrupt handler only keeps the time. The
+ *  software timers, the callback and the console flush run in a bottom
+ *  half, after the interrupt has been acknowledged. The software timers
+ *  share the wheel and the PIT with the rest of the driver, so they
+ *  still run with interrupts disabled, but the callback and the console
+ *  flush run with interrupts enabled, so that a slow callback does not
+ *  hold up the keyboard.
+ *
  *  @author Prajwal Yadapadithaya (pyadapad)
  *  @bug
  */
@@ -13,10 +34,78 @@
 #include <stdio.h>
 #include <simics.h>
 #include <asm.h>
+#include <eflags.h>
 #include <interrupt_defines.h>
+#include <timer_defines.h>
+
+#include "inc/console_driver.h"
+#include "inc/timer_driver.h"
+#include "inc/timer_wheel.h"
+#include "inc/irq.h"
+
+/*PIT constants. In rate generator mode (mode 2), the counter counts down
+  once per period, from the divisor to 1, so its value tells how far into
+  the period we are. The square wave mode counts down twice per period*/
+#define TIMER_RATE_GENERATOR 0x34
+#define TIMER_LATCH 0x00
+
+/*Read-back commands, which latch both the status and the counter of
+  channel 0, or only its status. Bit 7 of the status is the output,
+  which goes high when a one-shot count reaches 0. The counter then
+  wraps around to 0xFFFF*/
+#define TIMER_READ_BACK 0xC2
+#define TIMER_READ_STATUS 0xE2
+#define TIMER_STATUS_OUT 0x80
+#define TIMER_COUNTER_MASK 0xFFFF
+
+/*Range of the count of a one-shot*/
+#define TIMER_MIN_ONESHOT TIMER_MIN_DIVISOR
+#define TIMER_MAX_ONESHOT 0xFFFF
+#define LS_BYTE(x) ((x)&0xFF)
+#define MS_BYTE(x) (((x)>>8)&0xFF)
+
+/*PIC constants, to check if a timer interrupt is pending*/
+#define PIC_READ_IRR 0x0A
+#define TIMER_IRQ_BIT 0x01
+
+#define NS_PER_SEC 1000000000ULL
+#define MS_PER_SEC 1000
+
+/*PIT input clock periods over which the TSC is calibrated (0.5 seconds)*/
+#define TSC_CALIBRATION_COUNTS (TIMER_RATE/2)
 
 void (*callback_function) ();
-unsigned int tickcount;
+volatile unsigned int tickcount;
+unsigned int ticks_handled; /*Ticks run by the software timers and
+							  passed to the callback so far*/
+volatile int deferred = 0; /*1 if the ticks are handled in a bottom half*/
+
+volatile unsigned int timer_divisor; /*Current divisor of the PIT*/
+volatile uint64_t elapsed_counts; /*PIT input clock periods until the
+									last tick, or until the one-shot
+									was programmed in tickless mode*/
+
+volatile int tickless = 0; /*1 if the PIT is programmed in one-shot mode*/
+uint64_t tick_base_counts; /*Value of elapsed_counts at tick 0, in
+							tickless mode*/
+unsigned int oneshot_counts; /*Count the one-shot was programmed with*/
+uint64_t last_ns; /*Last value returned by timer_ns()*/
+
+uint64_t calibration_tsc; /*TSC and elapsed_counts at the start of the*/
+uint64_t calibration_counts; /*calibration*/
+volatile uint64_t tsc_hz; /*Calibrated TSC rate, 0 until calibrated*/
+
+/*Helper functions*/
+static unsigned int read_timer_counter(void);
+static int timer_irq_pending(void);
+static uint64_t current_counts(void);
+static void program_periodic(unsigned int);
+static void program_oneshot(void);
+static unsigned int clock_ticks(void);
+static int run_ticks(unsigned int);
+static void timer_bottom_half(void);
+static uint64_t counts_to_ns(uint64_t);
+static void calibrate_tsc(void);
 
 /**
  * @brief Function to initialize the callback function
@@ -30,17 +119,467 @@ unsigned int tickcount;
 void initialize_callback(void *func_addr) {
 	callback_function = func_addr;
 	tickcount = 0;
+	ticks_handled = 0;
 }
 
 /**
  * @brief Function which is called by the timer interrupt 
- * handler. This function is responsible for calling the 
- * callback function with the current count of timeticks.
+ * handler. This function is responsible for counting the tick,
+ * and, unless the timer is deferred, for handling it right away
+ * with timer_bottom_half().
  *
  * @return Void
  */
 void timer_tick() {
-	tickcount++;
-	callback_function(tickcount);
-	outb(INT_CTL_PORT, INT_ACK_CURRENT);
+	if(!tickless) {
+		tickcount++;
+		elapsed_counts += timer_divisor;
+		calibrate_tsc();
+	}
+	if(!deferred) {
+		timer_bottom_half();
+	}
+}
+
+/**
+ * @brief Function to handle the ticks counted by timer_tick(). This
+ * function is responsible for running the software timers which
+ * expire on these ticks, and calling the callback function with the
+ * current count of timeticks. The console is flushed to the screen
+ * after the callback returns, which also moves the hardware cursor.
+ *
+ * In tickless mode, the ticks since the last interrupt are worked
+ * out from the clock first, and the PIT is programmed for the next
+ * deadline afterwards. The clock is read, the software timers are run
+ * and the PIT is programmed with interrupts disabled, so that the
+ * read-back of the PIT cannot be split by another access to it. The
+ * callback and the flush run with interrupts as they were on entry,
+ * which is enabled in the bottom half.
+ *
+ * @return Void
+ */
+void timer_bottom_half() {
+	uint32_t eflags = get_eflags();
+	unsigned int now;
+	int ran;
+
+	disable_interrupts();
+	if(tickless) {
+		now = clock_ticks();
+		tickcount = now;
+		ran = run_ticks(now);
+		elapsed_counts = current_counts();
+		program_oneshot();
+		calibrate_tsc();
+	} else {
+		now = tickcount;
+		ran = run_ticks(now);
+	}
+	set_eflags(eflags);
+
+	if(ran) {
+		callback_function(now);
+	}
+	console_flush();
+}
+
+/**
+ * @brief Function to switch the timer between handling the ticks
+ * in the interrupt handler, with interrupts disabled, and deferring
+ * them to a bottom half. The bottom half still runs the software
+ * timers with interrupts disabled, but enables them for the callback
+ * and the console flush (see timer_bottom_half()).
+ *
+ * @param enable 1 to defer the ticks to a bottom half, 0 to handle
+ * them in the interrupt handler
+ *
+ * @return Void
+ */
+void timer_set_deferred(int enable) {
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	deferred = enable;
+	irq_register_bottom_half(TIMER_IRQ, enable ? timer_bottom_half : NULL);
+
+	set_eflags(eflags);
+}
+
+/**
+ * @brief Function to get the number of timer ticks
+ * received so far. In tickless mode, this is worked out
+ * from the clock, as there is no interrupt on every tick.
+ *
+ * @return Current tick count
+ */
+unsigned int timer_ticks() {
+	if(!tickless) {
+		return tickcount;
+	}
+
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+	unsigned int ticks = clock_ticks();
+	set_eflags(eflags);
+	return ticks;
+}
+
+/**
+ * @brief Function to switch the timer between periodic and tickless
+ * mode. When tickless mode is switched off, the ticks which have
+ * passed since the last interrupt are run first.
+ *
+ * @param enable 1 to switch to tickless mode, 0 to switch back
+ * to an interrupt on every tick
+ *
+ * @return Void
+ */
+void timer_set_tickless(int enable) {
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	if(enable && !tickless) {
+		tick_base_counts = elapsed_counts - (uint64_t)tickcount*timer_divisor;
+		elapsed_counts = current_counts();
+		tickless = 1;
+		program_oneshot();
+	} else if(!enable && tickless) {
+		unsigned int now = clock_ticks();
+		tickcount = now;
+		if(run_ticks(now)) {
+			callback_function(now);
+		}
+		elapsed_counts = current_counts();
+		tickless = 0;
+		program_periodic(timer_divisor);
+	}
+
+	set_eflags(eflags);
+}
+
+/**
+ * @brief Function called by the software timers when a timer is
+ * started, with interrupts disabled. In tickless mode, the PIT is
+ * programmed again, in case the timer expires before the current
+ * deadline. If the one-shot has already fired, the interrupt
+ * handler will program the next one.
+ *
+ * @return Void
+ */
+void timer_deadline_changed() {
+	if(!tickless) {
+		return;
+	}
+
+	/*Latch only the status, as a latched count which is not read
+	  would be returned by the next read of the counter*/
+	outb(TIMER_MODE_IO_PORT, TIMER_READ_STATUS);
+	if(inb(TIMER_PERIOD_IO_PORT) & TIMER_STATUS_OUT) {
+		return;
+	}
+	elapsed_counts = current_counts();
+	program_oneshot();
+}
+
+/**
+ * @brief Function to program the PIT to generate an interrupt
+ * every divisor periods of its input clock (TIMER_RATE Hz). The
+ * part of the current tick which has already passed is added to
+ * the clock, as reprogramming the PIT restarts the count. The
+ * divisor cannot be changed in tickless mode, where it is the
+ * length of the ticks the software timers count.
+ *
+ * @param divisor The new divisor, between TIMER_MIN_DIVISOR and
+ * TIMER_MAX_DIVISOR
+ *
+ * @return 0 if successful, -1 if the divisor is out of range or
+ * the timer is tickless
+ */
+int timer_set_divisor(unsigned int divisor) {
+	if(divisor < TIMER_MIN_DIVISOR || divisor > TIMER_MAX_DIVISOR) {
+		return -1;
+	}
+
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	if(tickless) {
+		set_eflags(eflags);
+		return -1;
+	}
+	if(timer_divisor != 0) {
+		elapsed_counts += timer_divisor - read_timer_counter();
+	}
+	program_periodic(divisor);
+	timer_divisor = divisor;
+
+	set_eflags(eflags);
+	return 0;
+}
+
+/**
+ * @brief Function to program the PIT to generate interrupts at
+ * (about) the given rate. The divisor is rounded to the nearest
+ * integer, so the actual rate can be found with timer_get_divisor().
+ *
+ * @param hz Number of interrupts per second
+ *
+ * @return 0 if successful, -1 if the rate is out of range
+ */
+int timer_set_rate(unsigned int hz) {
+	if(hz == 0) {
+		return -1;
+	}
+	return timer_set_divisor((TIMER_RATE + hz/2)/hz);
+}
+
+/**
+ * @brief Function to convert a time to the number of ticks which
+ * lasts about as long at the current rate of the PIT, so that the
+ * periods of software timers do not depend on the rate.
+ *
+ * @param ms Time in milliseconds
+ *
+ * @return Number of ticks, rounded to the nearest and at least 1
+ */
+unsigned int timer_ms_to_ticks(unsigned int ms) {
+	uint64_t tick_counts = (uint64_t)timer_divisor*MS_PER_SEC;
+	if(tick_counts == 0) {
+		return 1;
+	}
+	unsigned int ticks = ((uint64_t)ms*TIMER_RATE + tick_counts/2)/
+							tick_counts;
+	return (ticks > 0) ? ticks : 1;
+}
+
+/**
+ * @brief Function to get the current divisor of the PIT.
+ *
+ * @return Current divisor
+ */
+unsigned int timer_get_divisor() {
+	return timer_divisor;
+}
+
+/**
+ * @brief Function to get the time since the timer was started,
+ * in nanoseconds, with the resolution of the PIT input clock
+ * (about 838ns). The value never decreases.
+ *
+ * @return Time in nanoseconds
+ */
+uint64_t timer_ns() {
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	uint64_t ns = counts_to_ns(current_counts());
+	if(ns < last_ns) {
+		ns = last_ns;
+	} else {
+		last_ns = ns;
+	}
+
+	set_eflags(eflags);
+	return ns;
+}
+
+/**
+ * @brief Function to get the rate of the time stamp counter, as
+ * calibrated against the PIT.
+ *
+ * @return TSC cycles per second, 0 if the calibration is not
+ * done yet
+ */
+uint64_t timer_tsc_hz() {
+	return tsc_hz;
+}
+
+/**
+ * @brief Function to convert a number of TSC cycles, such as the
+ * difference between two rdtsc() calls, to nanoseconds.
+ *
+ * @param cycles Number of TSC cycles
+ *
+ * @return Nanoseconds, 0 if the calibration is not done yet
+ */
+uint64_t timer_cycles_to_ns(uint64_t cycles) {
+	uint64_t hz = tsc_hz;
+	if(hz == 0) {
+		return 0;
+	}
+	return (cycles/hz)*NS_PER_SEC + ((cycles%hz)*NS_PER_SEC)/hz;
+}
+
+/**
+ * @brief Function to latch and read the current value of the
+ * PIT counter. Must be called with interrupts disabled.
+ *
+ * @return Value of the counter, from the divisor down to 1
+ */
+unsigned int read_timer_counter() {
+	outb(TIMER_MODE_IO_PORT, TIMER_LATCH);
+	unsigned int counter = inb(TIMER_PERIOD_IO_PORT);
+	counter |= inb(TIMER_PERIOD_IO_PORT) << 8;
+	return counter;
+}
+
+/**
+ * @brief Function to get the number of PIT input clock periods
+ * since the timer was started. Must be called with interrupts
+ * disabled.
+ *
+ * In periodic mode, if the counter has already restarted but the
+ * interrupt for it has not been handled yet (interrupts are
+ * disabled, or it is being handled right now), the tick is counted
+ * here. In tickless mode, the time since the one-shot fired is
+ * counted from the counter, which keeps counting down after 0.
+ *
+ * @return Number of PIT input clock periods
+ */
+uint64_t current_counts() {
+	if(tickless) {
+		outb(TIMER_MODE_IO_PORT, TIMER_READ_BACK);
+		unsigned int status = inb(TIMER_PERIOD_IO_PORT);
+		unsigned int counter = inb(TIMER_PERIOD_IO_PORT);
+		counter |= inb(TIMER_PERIOD_IO_PORT) << 8;
+
+		if(status & TIMER_STATUS_OUT) {
+			return elapsed_counts + oneshot_counts +
+				((TIMER_COUNTER_MASK + 1 - counter) & TIMER_COUNTER_MASK);
+		}
+		if(counter > oneshot_counts) {
+			/*The count has not been loaded yet*/
+			return elapsed_counts;
+		}
+		return elapsed_counts + (oneshot_counts - counter);
+	}
+
+	unsigned int divisor = timer_divisor;
+	unsigned int counter = read_timer_counter();
+	uint64_t counts = elapsed_counts + (divisor - counter);
+	if(timer_irq_pending() && counter > divisor/2) {
+		counts += divisor;
+	}
+	return counts;
+}
+
+/**
+ * @brief Function to program the PIT to interrupt periodically.
+ *
+ * @param divisor Number of PIT input clock periods between interrupts
+ *
+ * @return Void
+ */
+void program_periodic(unsigned int divisor) {
+	outb(TIMER_MODE_IO_PORT, TIMER_RATE_GENERATOR);
+	outb(TIMER_PERIOD_IO_PORT, LS_BYTE(divisor));
+	outb(TIMER_PERIOD_IO_PORT, MS_BYTE(divisor));
+}
+
+/**
+ * @brief Function to program a one-shot of the PIT for the next tick
+ * on which a software timer has work to do, or as far as the counter
+ * allows. elapsed_counts must have been brought up to date just
+ * before. Must be called with interrupts disabled.
+ *
+ * @return Void
+ */
+void program_oneshot() {
+	unsigned int idle = soft_timer_next();
+	uint64_t deadline = tick_base_counts +
+		((uint64_t)ticks_handled + 1 + idle)*timer_divisor;
+	uint64_t counts = 0;
+
+	if(deadline > elapsed_counts) {
+		counts = deadline - elapsed_counts;
+	}
+	if(counts < TIMER_MIN_ONESHOT) {
+		counts = TIMER_MIN_ONESHOT;
+	} else if(counts > TIMER_MAX_ONESHOT) {
+		counts = TIMER_MAX_ONESHOT;
+	}
+
+	outb(TIMER_MODE_IO_PORT, TIMER_ONE_SHOT);
+	outb(TIMER_PERIOD_IO_PORT, LS_BYTE(counts));
+	outb(TIMER_PERIOD_IO_PORT, MS_BYTE(counts));
+	oneshot_counts = counts;
+}
+
+/**
+ * @brief Function to work out the tick count from the clock, in
+ * tickless mode. Must be called with interrupts disabled.
+ *
+ * @return Number of ticks since the timer was started
+ */
+unsigned int clock_ticks() {
+	return (current_counts() - tick_base_counts)/timer_divisor;
+}
+
+/**
+ * @brief Function to run the software timers on the ticks which have
+ * passed since they last ran. The caller calls the callback function
+ * if any tick was run. Must be called with interrupts disabled.
+ *
+ * @param now The current tick count
+ *
+ * @return 1 if any tick was run, 0 if not
+ */
+int run_ticks(unsigned int now) {
+	if(now == ticks_handled) {
+		return 0;
+	}
+	soft_timer_advance(now - ticks_handled);
+	ticks_handled = now;
+	return 1;
+}
+
+/**
+ * @brief Function to check if a timer interrupt is waiting to
+ * be handled, by reading the interrupt request register of the PIC.
+ *
+ * @return 1 if a timer interrupt is pending, 0 if not
+ */
+int timer_irq_pending() {
+	outb(INT_CTL_PORT, PIC_READ_IRR);
+	return (inb(INT_CTL_PORT) & TIMER_IRQ_BIT) != 0;
+}
+
+/**
+ * @brief Function to convert a number of PIT input clock periods
+ * to nanoseconds. Whole seconds are converted separately so that
+ * the multiplication cannot overflow.
+ *
+ * @param counts Number of PIT input clock periods
+ *
+ * @return Nanoseconds
+ */
+uint64_t counts_to_ns(uint64_t counts) {
+	return (counts/TIMER_RATE)*NS_PER_SEC +
+		((counts%TIMER_RATE)*NS_PER_SEC)/TIMER_RATE;
+}
+
+/**
+ * @brief Function called on every tick until the TSC is calibrated.
+ * The TSC is read on the first tick, and again on the first tick
+ * after TSC_CALIBRATION_COUNTS PIT input clock periods, which gives
+ * its rate.
+ *
+ * @return Void
+ */
+void calibrate_tsc() {
+	if(tsc_hz != 0) {
+		return;
+	}
+
+	uint64_t now = rdtsc();
+	if(calibration_tsc == 0) {
+		calibration_tsc = now;
+		calibration_counts = elapsed_counts;
+		return;
+	}
+
+	uint64_t counts = elapsed_counts - calibration_counts;
+	if(counts >= TSC_CALIBRATION_COUNTS) {
+		tsc_hz = ((now - calibration_tsc)*TIMER_RATE)/counts;
+	}
 }
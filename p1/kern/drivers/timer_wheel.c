@@ -0,0 +1,321 @@
+/** @file timer_wheel.c
+ *
+ *  @brief Software timers, run on the ticks of the timer driver.
+ *  Any number of one-shot and periodic timers can be started.
+ *
+ *  The timers are kept in a hierarchical timing wheel. Each level
+ *  has WHEEL_SIZE slots, and each slot is a list of timers. Level 0
+ *  has one slot per tick; a slot of level n covers WHEEL_SIZE times
+ *  as many ticks as a slot of level n-1. A timer is put in the lowest
+ *  level whose range covers its delay. Every WHEEL_SIZE ticks of a
+ *  level, the timers of the next slot of the level above are moved
+ *  (cascaded) down. Starting and cancelling a timer take constant
+ *  time, and a tick only touches the timers which expire on it,
+ *  apart from the cascades.
+ *
+ *  When the timer driver is tickless, it asks soft_timer_next() how
+ *  many ticks have no work, and skips them with soft_timer_advance().
+ *  Starting a timer tells the driver, so that it can wake up earlier.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug No known bugs
+ */
+
+#include <p1kern.h>
+#include <stddef.h>
+#include <asm.h>
+#include <eflags.h>
+
+#include "inc/timer_wheel.h"
+#include "inc/timer_driver.h"
+
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE-1)
+#define WHEEL_LEVELS 4
+
+/*Slot of a level which an expiry time falls in*/
+#define WHEEL_INDEX(time, level) (((time) >> ((level)*WHEEL_BITS)) & WHEEL_MASK)
+
+soft_timer *wheel[WHEEL_LEVELS][WHEEL_SIZE];
+
+/*The next tick to be run. Timers expiring before it run on it*/
+unsigned int wheel_time = 0;
+
+/*Helper functions*/
+static void add_timer(soft_timer *);
+static void remove_timer(soft_timer *);
+static void move_list(soft_timer **, soft_timer **);
+static int cascade(int);
+
+/**
+ * @brief Function to initialize a timer. Must be called before
+ * the timer is started for the first time.
+ *
+ * @param timer The timer
+ * @param func Function to be called when the timer expires. It is
+ * called with interrupts disabled, from the timer interrupt handler
+ * or its bottom half, and may start or cancel any timer, including
+ * this one
+ * @param arg Argument passed to func
+ *
+ * @return Void
+ */
+void soft_timer_init(soft_timer *timer, void (*func)(void *), void *arg) {
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->expires = 0;
+	timer->period = 0;
+	timer->func = func;
+	timer->arg = arg;
+}
+
+/**
+ * @brief Function to start a timer. If the timer is already
+ * pending, it is restarted.
+ *
+ * @param timer The timer
+ * @param delay Number of ticks after which the timer expires
+ * for the first time. 0 and 1 both expire on the next tick
+ * @param period Number of ticks between later expiries, 0 if
+ * the timer should expire only once
+ *
+ * @return 0 if successful, -1 if the timer has no function
+ */
+int soft_timer_start(soft_timer *timer, unsigned int delay,
+		unsigned int period) {
+	if(timer->func == NULL) {
+		return -1;
+	}
+	if(delay > SOFT_TIMER_MAX_DELAY) {
+		delay = SOFT_TIMER_MAX_DELAY;
+	}
+	if(period > SOFT_TIMER_MAX_DELAY) {
+		period = SOFT_TIMER_MAX_DELAY;
+	}
+
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	if(timer->pprev != NULL) {
+		remove_timer(timer);
+	}
+	/*The tick being run now, if any, is wheel_time-1*/
+	timer->expires = wheel_time - 1 + (delay ? delay : 1);
+	timer->period = period;
+	add_timer(timer);
+	timer_deadline_changed();
+
+	set_eflags(eflags);
+	return 0;
+}
+
+/**
+ * @brief Function to cancel a timer. Once this returns, the timer
+ * function is not called again, unless the timer is started again.
+ *
+ * @param timer The timer
+ *
+ * @return 1 if the timer was pending, 0 if not
+ */
+int soft_timer_cancel(soft_timer *timer) {
+	int pending = 0;
+	uint32_t eflags = get_eflags();
+	disable_interrupts();
+
+	if(timer->pprev != NULL) {
+		remove_timer(timer);
+		pending = 1;
+	}
+
+	set_eflags(eflags);
+	return pending;
+}
+
+/**
+ * @brief Function to check if a timer is pending.
+ *
+ * @param timer The timer
+ *
+ * @return 1 if the timer is pending, 0 if not
+ */
+int soft_timer_pending(soft_timer *timer) {
+	return timer->pprev != NULL;
+}
+
+/**
+ * @brief Function called by the timer driver on every tick, with
+ * interrupts disabled. Cascades the timers of the higher levels if
+ * needed, and runs the timers which expire on this tick. Periodic
+ * timers are started again before their function is called.
+ *
+ * @return Void
+ */
+void soft_timer_tick() {
+	soft_timer *expired = NULL;
+	int index = WHEEL_INDEX(wheel_time, 0);
+	int level;
+
+	/*Cascade level n only when level n-1 has wrapped around*/
+	for(level = 1; index == 0 && level < WHEEL_LEVELS; level++) {
+		index = cascade(level);
+	}
+
+	/*Move the expiring timers to a list of their own, so that the
+	  timer functions can start and cancel timers of this slot*/
+	move_list(&wheel[0][WHEEL_INDEX(wheel_time, 0)], &expired);
+	wheel_time++;
+
+	while(expired != NULL) {
+		soft_timer *timer = expired;
+		remove_timer(timer);
+		if(timer->period != 0) {
+			timer->expires += timer->period;
+			add_timer(timer);
+		}
+		timer->func(timer->arg);
+	}
+}
+
+/**
+ * @brief Function called by the timer driver to run a number of
+ * ticks at once, with interrupts disabled. Ticks on which no timer
+ * expires and no cascade is needed are skipped without touching
+ * the wheel.
+ *
+ * @param ticks Number of ticks to be run
+ *
+ * @return Void
+ */
+void soft_timer_advance(unsigned int ticks) {
+	while(ticks > 0) {
+		unsigned int idle = (ticks > 1) ? soft_timer_next() : 0;
+		if(idle >= ticks) {
+			idle = ticks - 1;
+		}
+		wheel_time += idle;
+		ticks -= idle;
+
+		soft_timer_tick();
+		ticks--;
+	}
+}
+
+/**
+ * @brief Function to find the number of ticks, from the next tick to
+ * be run, which can be skipped because no timer expires on them and
+ * no cascade is needed. A slot of a higher level is counted from the
+ * tick on which it is cascaded, which is no later than the expiry of
+ * any of its timers.
+ *
+ * @return Number of ticks before the first tick with work, or
+ * SOFT_TIMER_NONE if no timer is pending
+ */
+unsigned int soft_timer_next() {
+	unsigned int next = SOFT_TIMER_NONE;
+	int level, i;
+
+	for(level = 0; level < WHEEL_LEVELS; level++) {
+		unsigned int unit = 1u << (level*WHEEL_BITS);
+		/*First tick, from the next one, on which the level moves*/
+		unsigned int time = (wheel_time + unit - 1) & ~(unit - 1);
+
+		for(i = 0; i < WHEEL_SIZE; i++, time += unit) {
+			if(wheel[level][WHEEL_INDEX(time, level)] != NULL) {
+				if(time - wheel_time < next) {
+					next = time - wheel_time;
+				}
+				break;
+			}
+		}
+	}
+	return next;
+}
+
+/**
+ * @brief Function to add a timer to the slot of the wheel which
+ * its expiry time falls in. Must be called with interrupts disabled.
+ *
+ * @param timer The timer
+ *
+ * @return Void
+ */
+void add_timer(soft_timer *timer) {
+	unsigned int delta = timer->expires - wheel_time;
+	soft_timer **slot;
+	int level;
+
+	if((int)delta < 0) {
+		/*Already expired, run it on the next tick*/
+		slot = &wheel[0][WHEEL_INDEX(wheel_time, 0)];
+	} else {
+		for(level = 0; level < WHEEL_LEVELS-1; level++) {
+			if(delta < (1u << ((level+1)*WHEEL_BITS))) {
+				break;
+			}
+		}
+		slot = &wheel[level][WHEEL_INDEX(timer->expires, level)];
+	}
+
+	timer->next = *slot;
+	if(*slot != NULL) {
+		(*slot)->pprev = &timer->next;
+	}
+	*slot = timer;
+	timer->pprev = slot;
+}
+
+/**
+ * @brief Function to remove a timer from the list it is on. Must be
+ * called with interrupts disabled.
+ *
+ * @param timer The timer
+ *
+ * @return Void
+ */
+void remove_timer(soft_timer *timer) {
+	*timer->pprev = timer->next;
+	if(timer->next != NULL) {
+		timer->next->pprev = timer->pprev;
+	}
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+/**
+ * @brief Function to move all the timers from one list to another,
+ * empty, list.
+ *
+ * @param from The list to be emptied
+ * @param to The empty list
+ *
+ * @return Void
+ */
+void move_list(soft_timer **from, soft_timer **to) {
+	*to = *from;
+	*from = NULL;
+	if(*to != NULL) {
+		(*to)->pprev = to;
+	}
+}
+
+/**
+ * @brief Function to move the timers of the current slot of a level
+ * down to the levels below it.
+ *
+ * @param level The level to be cascaded
+ *
+ * @return Index of the slot which was cascaded
+ */
+int cascade(int level) {
+	int index = WHEEL_INDEX(wheel_time, level);
+	soft_timer *list = NULL;
+
+	move_list(&wheel[level][index], &list);
+	while(list != NULL) {
+		soft_timer *timer = list;
+		remove_timer(timer);
+		add_timer(timer);
+	}
+	return index;
+}
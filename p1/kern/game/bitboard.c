@@ -0,0 +1,324 @@
+/**
+ * @file bitboard.c
+ * @brief Flood-It engine on bitboards. Each color of the board is a
+ * bitmask, and the flooded region is grown by dilating it with shifts
+ * and masking it with the cells of the new color until it stops
+ * changing. Counting the region and checking for a win are popcounts
+ * and compares over a few words, so positions are cheap to copy and
+ * to play out, as needed to search for moves.
+ *
+ * @author Prajwal Yadapadithaya (pyadapad)
+ * @bug None
+ */
+
+#include "inc/bitboard.h"
+
+/*Helper functions*/
+static void bb_set(const bb_game *, bitboard *, int, int);
+static void bb_dilate(const bb_game *, const bitboard *, bitboard *);
+static void bb_grow(const bb_game *, bitboard *, const bitboard *);
+static int popcount64(uint64_t);
+
+/**
+ * @brief Function to build the bitboards of a board.
+ *
+ * @param game The bitboards to be built
+ * @param grid 2D array containing the grid colors
+ * @param size Length and height of the grid
+ * @param colors Number of colors in the grid
+ *
+ * @return Void
+ */
+void bb_load(bb_game *game, char grid[][MAX_BOARD_SIZE], int size,
+			int colors) {
+	int i, j;
+
+	game->size = size;
+	game->stride = size + 1;
+	game->words = (size*game->stride + 63)/64;
+	game->colors = colors;
+
+	bb_clear(&game->board);
+	for(i=0; i<colors; i++) {
+		bb_clear(&game->color[i]);
+	}
+	for(i=0; i<size; i++) {
+		for(j=0; j<size; j++) {
+			bb_set(game, &game->board, i, j);
+			bb_set(game, &game->color[grid[i][j]/COLOR_CODE_MULTIPLIER],
+					i, j);
+		}
+	}
+}
+
+/**
+ * @brief Function to add a list of cells to a set. The flooded region
+ * of the game is tracked as a list of cells by region.c, and its
+ * bitboard is kept up to date from the cells the list adds.
+ *
+ * @param game The board
+ * @param set The set of cells
+ * @param cells The cells to be added
+ * @param count Number of cells to be added
+ *
+ * @return Void
+ */
+void bb_add_cells(const bb_game *game, bitboard *set, const grid_cell *cells,
+				int count) {
+	int i;
+
+	for(i=0; i<count; i++) {
+		bb_set(game, set, cells[i].x, cells[i].y);
+	}
+}
+
+/**
+ * @brief Function to flood the region with a color. The region
+ * absorbs the cells of the color connected to it.
+ *
+ * @param game The board
+ * @param region The region, which is grown
+ * @param color The new color of the region
+ *
+ * @return Number of cells absorbed
+ */
+int bb_play(const bb_game *game, bitboard *region, int color) {
+	int before = bb_count(game, region);
+
+	bb_grow(game, region, &game->color[color]);
+	return bb_count(game, region) - before;
+}
+
+/**
+ * @brief Function to find the frontier of a region, which is the cells
+ * next to it, but not in it.
+ *
+ * @param game The board
+ * @param region The region
+ * @param frontier Set to the frontier
+ *
+ * @return Void
+ */
+void bb_frontier(const bb_game *game, const bitboard *region,
+				bitboard *frontier) {
+	int i;
+
+	bb_dilate(game, region, frontier);
+	for(i=0; i<game->words; i++) {
+		frontier->w[i] &= ~region->w[i];
+	}
+}
+
+/**
+ * @brief Function to count the cells of a set.
+ *
+ * @param game The board
+ * @param set The set of cells
+ *
+ * @return Number of cells in the set
+ */
+int bb_count(const bb_game *game, const bitboard *set) {
+	int i, count = 0;
+
+	for(i=0; i<game->words; i++) {
+		count += popcount64(set->w[i]);
+	}
+	return count;
+}
+
+/**
+ * @brief Function to check if a set has no cells.
+ *
+ * @param game The board
+ * @param set The set of cells
+ *
+ * @return 1 if the set is empty, 0 otherwise
+ */
+int bb_empty(const bb_game *game, const bitboard *set) {
+	int i;
+
+	for(i=0; i<game->words; i++) {
+		if(set->w[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Function to check if two sets have a cell in common.
+ *
+ * @param game The board
+ * @param a A set of cells
+ * @param b A set of cells
+ *
+ * @return 1 if the sets meet, 0 otherwise
+ */
+int bb_touches(const bb_game *game, const bitboard *a, const bitboard *b) {
+	int i;
+
+	for(i=0; i<game->words; i++) {
+		if(a->w[i] & b->w[i]) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Function to check if a set contains all the cells of another.
+ *
+ * @param game The board
+ * @param a A set of cells
+ * @param b A set of cells
+ *
+ * @return 1 if every cell of b is in a, 0 otherwise
+ */
+int bb_covers(const bb_game *game, const bitboard *a, const bitboard *b) {
+	int i;
+
+	for(i=0; i<game->words; i++) {
+		if(b->w[i] & ~a->w[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Function to check if a region covers the whole board.
+ *
+ * @param game The board
+ * @param region The region
+ *
+ * @return 1 if the board is flooded, 0 otherwise
+ */
+int bb_flooded(const bb_game *game, const bitboard *region) {
+	int i;
+
+	for(i=0; i<game->words; i++) {
+		if(region->w[i] != game->board.w[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Function to empty a set.
+ *
+ * @param set The set of cells
+ *
+ * @return Void
+ */
+void bb_clear(bitboard *set) {
+	int i;
+
+	for(i=0; i<BB_WORDS; i++) {
+		set->w[i] = 0;
+	}
+}
+
+/**
+ * @brief Function to add a cell to a set.
+ *
+ * @param game The board
+ * @param set The set of cells
+ * @param x Row of the cell
+ * @param y Column of the cell
+ *
+ * @return Void
+ */
+void bb_set(const bb_game *game, bitboard *set, int x, int y) {
+	int bit = x*game->stride + y;
+
+	set->w[bit/64] |= (uint64_t)1 << (bit%64);
+}
+
+/**
+ * @brief Function to add to a set the cells next to it. The set is
+ * shifted by one column and by one row each way. Cells shifted off the
+ * sides of the board land on guard bits, or off the board, and are
+ * masked off.
+ *
+ * @param game The board
+ * @param set The set of cells
+ * @param out Set to the cells of the set and the cells next to them
+ *
+ * @return Void
+ */
+void bb_dilate(const bb_game *game, const bitboard *set, bitboard *out) {
+	int words = game->words;
+	int rw = game->stride/64, rb = game->stride%64;
+	int i;
+
+	for(i=0; i<words; i++) {
+		uint64_t w = set->w[i];
+		uint64_t prev = (i > 0) ? set->w[i-1] : 0;
+		uint64_t next = (i < words-1) ? set->w[i+1] : 0;
+		uint64_t up = 0, down = 0;
+
+		w |= (w << 1) | (prev >> 63) | (w >> 1) | (next << 63);
+
+		/*Shift by a row, which may span words on large boards*/
+		if(i-rw >= 0) {
+			down = set->w[i-rw] << rb;
+			if(rb && i-rw-1 >= 0) {
+				down |= set->w[i-rw-1] >> (64-rb);
+			}
+		}
+		if(i+rw < words) {
+			up = set->w[i+rw] >> rb;
+			if(rb && i+rw+1 < words) {
+				up |= set->w[i+rw+1] << (64-rb);
+			}
+		}
+		out->w[i] = (w | up | down) & game->board.w[i];
+	}
+}
+
+/**
+ * @brief Function to grow a region into the connected cells of a
+ * color, by dilating it and masking it with the color until it stops
+ * changing.
+ *
+ * @param game The board
+ * @param region The region, which is grown
+ * @param color The cells of the color
+ *
+ * @return Void
+ */
+void bb_grow(const bb_game *game, bitboard *region, const bitboard *color) {
+	bitboard grown;
+	int i, changed;
+
+	do {
+		bb_dilate(game, region, &grown);
+		changed = 0;
+		for(i=0; i<game->words; i++) {
+			uint64_t w = grown.w[i] & (region->w[i] | color->w[i]);
+			changed |= (w != region->w[i]);
+			region->w[i] = w;
+		}
+	} while(changed);
+}
+
+/**
+ * @brief Function to count the set bits of a word. The kernel is not
+ * linked with libgcc, so the compiler's popcount builtin is not used.
+ *
+ * @param w The word
+ *
+ * @return Number of set bits in the word
+ */
+int popcount64(uint64_t w) {
+	uint32_t lo = (uint32_t)w, hi = (uint32_t)(w >> 32);
+
+	lo = lo - ((lo >> 1) & 0x55555555);
+	hi = hi - ((hi >> 1) & 0x55555555);
+	lo = (lo & 0x33333333) + ((lo >> 2) & 0x33333333);
+	hi = (hi & 0x33333333) + ((hi >> 2) & 0x33333333);
+	lo = (lo + (lo >> 4)) & 0x0F0F0F0F;
+	hi = (hi + (hi >> 4)) & 0x0F0F0F0F;
+	return (int)(((lo + hi) * 0x01010101) >> 24);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file console_bench.c
+ * @brief Benchmarks of the console driver, run from the interrupt
+ * statistics screen. Each benchmark draws on the screen, and is timed
+ * with timer_ns(). The results are written to the Simics console with
+ * lprintf(), as the screen is drawn over by the benchmarks themselves.
+ *
+ * The console is benchmarked unbuffered, drawing straight to video
+ * memory, and then buffered, as the game draws.
+ *
+ * @author Prajwal Yadapadithaya (pyadapad)
+ * @bug None
+ */
+
+#include "inc/game_controller.h"
+#include "inc/console_bench.h"
+
+#define NS_PER_SEC 1000000000ULL
+
+/*Arguments of set_cursor() which put the cursor on the first cell of
+  the screen. The driver counts rows from 1 and columns from 2*/
+#define HOME_ROW 1
+#define HOME_COL 2
+
+/*Text printed by the printf benchmark*/
+static char bench_text[BENCH_TEXT_LENGTH + 1];
+
+/*Helper functions*/
+static void init_bench_text(void);
+static void bench_printf(const char *);
+static void bench_clear(const char *);
+static unsigned int per_second(uint64_t, uint64_t);
+
+/**
+ * @brief Function to run the benchmarks of the console. The console
+ * is left buffered, as the game expects it to be.
+ *
+ * @return Void
+ */
+void console_benchmark() {
+	init_bench_text();
+
+	console_set_buffered(0);
+	bench_printf("unbuffered");
+	bench_clear("unbuffered");
+
+	console_set_buffered(1);
+	bench_printf("buffered");
+	bench_clear("buffered");
+	console_flush();
+}
+
+/**
+ * @brief Function to fill the text of the printf benchmark with lines
+ * of letters.
+ *
+ * @return Void
+ */
+void init_bench_text() {
+	int i;
+
+	for(i=0; i<BENCH_TEXT_LENGTH; i++) {
+		if(i%BENCH_LINE_LENGTH == BENCH_LINE_LENGTH-1) {
+			bench_text[i] = '\n';
+		} else {
+			bench_text[i] = 'a' + i%26;
+		}
+	}
+	bench_text[BENCH_TEXT_LENGTH] = '\0';
+}
+
+/**
+ * @brief Function to time long calls to printf(), which scroll the
+ * screen as they go.
+ *
+ * @param mode Name of the mode of the console, for the log
+ *
+ * @return Void
+ */
+void bench_printf(const char *mode) {
+	int i;
+
+	clear_console();
+	uint64_t start = timer_ns();
+	for(i=0; i<BENCH_PRINTF_RUNS; i++) {
+		printf("%s", bench_text);
+	}
+	console_flush();
+	uint64_t ns = timer_ns() - start;
+
+	uint64_t chars = (uint64_t)BENCH_PRINTF_RUNS*BENCH_TEXT_LENGTH;
+	lprintf("Console printf (%s): %u chars in %u us, %u chars/s", mode,
+			(unsigned int)chars, (unsigned int)(ns/1000),
+			per_second(chars, ns));
+}
+
+/**
+ * @brief Function to time clearing the screen with clear_console(),
+ * which fills it a row at a time, against printing a space into
+ * every cell with putbyte(), one cell at a time. putbyte() would
+ * scroll the screen after the last cell, so that cell is drawn with
+ * draw_char() instead.
+ *
+ * @param mode Name of the mode of the console, for the log
+ *
+ * @return Void
+ */
+void bench_clear(const char *mode) {
+	int i, j, color;
+
+	get_term_color(&color);
+	uint64_t start = timer_ns();
+	for(i=0; i<BENCH_CLEAR_RUNS; i++) {
+		clear_console();
+	}
+	console_flush();
+	uint64_t fill_ns = timer_ns() - start;
+
+	start = timer_ns();
+	for(i=0; i<BENCH_CLEAR_RUNS; i++) {
+		if(set_cursor(HOME_ROW, HOME_COL) < 0) {
+			lprintf("Console clear (%s): cannot home the cursor", mode);
+			return;
+		}
+		for(j=0; j<CONSOLE_WIDTH*CONSOLE_HEIGHT-1; j++) {
+			putbyte(' ');
+		}
+		draw_char(CONSOLE_HEIGHT, CONSOLE_WIDTH, ' ', color);
+	}
+	console_flush();
+	uint64_t putbyte_ns = timer_ns() - start;
+
+	lprintf("Console clear (%s): fill %u ns, putbyte %u ns per clear, "
+			"%u clears/s against %u", mode,
+			(unsigned int)(fill_ns/BENCH_CLEAR_RUNS),
+			(unsigned int)(putbyte_ns/BENCH_CLEAR_RUNS),
+			per_second(BENCH_CLEAR_RUNS, fill_ns),
+			per_second(BENCH_CLEAR_RUNS, putbyte_ns));
+}
+
+/**
+ * @brief Function to work out the rate of something counted over
+ * a time.
+ *
+ * @param count Number of things counted
+ * @param ns Time they were counted over, in ns
+ *
+ * @return Things per second, 0 if no time passed
+ */
+unsigned int per_second(uint64_t count, uint64_t ns) {
+	if(ns == 0) {
+		return 0;
+	}
+	return (unsigned int)((count*NS_PER_SEC)/ns);
+}
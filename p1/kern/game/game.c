@@ -11,18 +11,25 @@
 
 /** @brief Kernel entrypoint.
  *  This is the entrypoint for the kernel. It simply sets up the
- *  drivers and passes control off to begin_game();
+ *  drivers and passes control off to begin_game(); Drawing on the
+ *  console is buffered, and reaches the screen after every event.
+ *  The timer is tickless, so the CPU is only woken up when a timer
+ *  of the game expires, and deferred, so that its callbacks do not
+ *  hold up the keyboard.
  *
  * @return Does not return
  */
 int kernel_main(mbinfo_t *mbinfo, int argc, char **argv, char **envp) {
 	handler_install(tick);
+	timer_set_tickless(1);
+	timer_set_deferred(1);
+	console_set_buffered(1);
 	enable_interrupts();
 	initialize_game();
 	begin_game();
 
 	while (1) {
-		continue;
+		__asm__ __volatile__("hlt");
 	}
 	return 0;
 }
@@ -19,7 +19,14 @@ volatile enum SCREEN cur_screen;
 enum SCREEN prev_screen; /*Used only for help screeen, as it can be called from
 							two differnt screens*/
 
+soft_timer clock_timer;
+soft_timer blink_timer;
+
 static void init_scores(void);
+static void init_timers(void);
+static void set_screen(enum SCREEN);
+static void run_timer(soft_timer *, int, unsigned int);
+static void post_timer_event(void *);
 
 /**
  * @brief This function is used to initialize the key 
@@ -33,31 +40,124 @@ void initialize_game() {
 	cur_color_count = -1;
 	cur_max_moves = -1;
 	init_scores();
+	init_timers();
 	switch_to_title_screen();
 }
 
 /**
- * @brief Starts the flow of the game by calling 
- * read_key_char() in key_handler.c. This method
- * should return only if the game is terminated
- * somehow.
+ * @brief Starts the flow of the game. This is the event loop
+ * of the game: it waits for the events posted by the interrupt
+ * handlers and handles them one by one. All the drawing happens
+ * here, outside interrupt context, and is flushed to the screen
+ * after every event. This method should return only if the game
+ * is terminated somehow.
  *
  * return Void
  */
 void begin_game() {
-	read_key_char();	
+	event ev;
+	int ch;
+
+	while(1) {
+		wait_event(&ev);
+		switch(ev.type) {
+			case EVENT_KEY:
+				while((ch = readchar()) != -1) {
+					handle_key(ch);
+				}
+				break;
+			case EVENT_TIMER:
+				if(cur_screen == DEBUG_SCREEN && ev.data == CLOCK_TIMER) {
+					paint_debug_screen();
+				}
+				if(cur_screen != GAME_SCREEN) {
+					break;
+				}
+				if(ev.data == CLOCK_TIMER) {
+					increment_time();
+				} else if(ev.data == BLINK_TIMER) {
+					blink_selection();
+				}
+				break;
+			default:
+				break;
+		}
+		console_flush();
+	}
 }
 
-/** @brief Tick function, used to keep track of the time
- * elapsed in this real time Flood-It game. 
+/** @brief Tick function, used to count the ticks since the
+ * game was started. The time elapsed in a game is kept by the
+ * clock timer. The timer is tickless, so this is not called on
+ * every tick, and numTicks can grow by more than one.
  *
  * @return Void
  **/
 void tick(unsigned int numTicks) {
-	if((cur_screen == GAME_SCREEN) && ((numTicks % 100) == 0)) {
-		increment_time();
+	num_ticks = numTicks;
+}
+
+/**
+ * @brief Initializes the periodic software timers of the game. Each
+ * timer posts an event with its id when it expires, which
+ * begin_game() handles. The timers only run on the screens which
+ * use them (see set_screen()).
+ *
+ * @return Void
+ */
+void init_timers() {
+	soft_timer_init(&clock_timer, post_timer_event, (void *)CLOCK_TIMER);
+	soft_timer_init(&blink_timer, post_timer_event, (void *)BLINK_TIMER);
+}
+
+/**
+ * @brief Sets the current screen, and starts or cancels the software
+ * timers of the game for it. The clock timer runs on the gameplay
+ * screen, which shows the elapsed time, and on the interrupt
+ * statistics screen, which is repainted with it. The blink timer runs
+ * only on the gameplay screen. Otherwise the timers are cancelled, so
+ * that a tickless timer does not wake the CPU up for nothing.
+ *
+ * @param screen The new screen
+ *
+ * @return Void
+ */
+void set_screen(enum SCREEN screen) {
+	run_timer(&clock_timer, screen == GAME_SCREEN || screen == DEBUG_SCREEN,
+				timer_ms_to_ticks(CLOCK_PERIOD_MS));
+	run_timer(&blink_timer, screen == GAME_SCREEN,
+				timer_ms_to_ticks(BLINK_PERIOD_MS));
+	cur_screen = screen;
+}
+
+/**
+ * @brief Starts a periodic timer of the game if it should run and is
+ * not running yet, or cancels it if it should not run.
+ *
+ * @param timer The timer
+ * @param run 1 if the timer should run, 0 if not
+ * @param period Period of the timer, in ticks
+ *
+ * @return Void
+ */
+void run_timer(soft_timer *timer, int run, unsigned int period) {
+	if(!run) {
+		soft_timer_cancel(timer);
+	} else if(!soft_timer_pending(timer)) {
+		soft_timer_start(timer, period, period);
 	}
-	num_ticks++;
+}
+
+/**
+ * @brief Function called from the timer interrupt handler when
+ * a software timer of the game expires.
+ *
+ * @param id The GAME_TIMER id of the timer
+ *
+ * @return Void
+ */
+void post_timer_event(void *id) {
+	post_event(EVENT_TIMER, (unsigned int)id);
 }
 
 /**
@@ -153,7 +253,7 @@ void restore_previous_screen() {
  */
 void switch_to_title_screen() {	
 	paint_title_screen();
-	cur_screen = TITLE_SCREEN;
+	set_screen(TITLE_SCREEN);
 }
 
 /**
@@ -167,7 +267,7 @@ void switch_to_board_sel() {
 		return;
 	}
 	paint_board_sel_screen();
-	cur_screen = BOARD_SEL_SCREEN;	
+	set_screen(BOARD_SEL_SCREEN);
 }
 
 /**
@@ -181,7 +281,7 @@ void switch_to_color_sel() {
 		return;
 	}
 	paint_color_sel_screen();
-	cur_screen = COLOR_SEL_SCREEN;
+	set_screen(COLOR_SEL_SCREEN);
 }
 
 /**
@@ -191,9 +291,8 @@ void switch_to_color_sel() {
  * @return Void
  */
 void switch_to_game() {
-	set_max_moves(); /*Set the maximum moves allowed for the game*/	
 	start_gameplay();
-	cur_screen = GAME_SCREEN;
+	set_screen(GAME_SCREEN);
 }
 
 /**
@@ -204,7 +303,7 @@ void switch_to_game() {
  */
 void resume_game() {
 	resume_gameplay();
-	cur_screen = GAME_SCREEN;
+	set_screen(GAME_SCREEN);
 }
 
 /**
@@ -216,7 +315,19 @@ void resume_game() {
  */
 void switch_to_instr() {
 	paint_instr_screen();
-	cur_screen = INSTR_SCREEN;
+	set_screen(INSTR_SCREEN);
+}
+
+/**
+ * @brief Switches the current screen to the interrupt statistics
+ * screen. This screen can be reached only from the title screen,
+ * and is repainted every time the clock timer expires.
+ *
+ * @return Void
+ */
+void switch_to_debug() {
+	paint_debug_screen();
+	set_screen(DEBUG_SCREEN);
 }
 
 /**
@@ -227,7 +338,7 @@ void switch_to_instr() {
  */
 void switch_to_pause() {
 	paint_pause_screen();
-	cur_screen = PAUSE_SCREEN;
+	set_screen(PAUSE_SCREEN);
 }
 
 /**
@@ -238,7 +349,7 @@ void switch_to_pause() {
  */
 void switch_to_end(int success) {
 	paint_end_screen(success);
-	cur_screen = END_SCREEN;
+	set_screen(END_SCREEN);
 }
 
 /**
@@ -274,27 +385,10 @@ void set_color_count(int color_index) {
  * @brief Sets the maximum number of moves allowed for the 
  * current game.
  *
- * @param type_index Index of the type in the array board_type
- * @param color_index Index of the count in the array color_count
+ * @param moves Moves the solver needs to flood the board
  *
  * @return Void
  */
-void set_max_moves() {
-	int i;
-	int type_index=-1, color_index=-1;
-	for(i=0; i<BOARD_SIZE_COUNT; i++) {
-		if(board_type[i] == cur_board_type) {
-			type_index = i;
-			break;
-		}
-	}
-	for(i=0; i<COLOR_COUNT; i++) {
-		if(color_count[i] == cur_color_count) {
-			color_index = i;
-			break;
-		}
-	}
-	if(type_index != -1 && color_index != -1) {
-		cur_max_moves = max_moves[type_index][color_index];
-	}
+void set_max_moves(int moves) {
+	cur_max_moves = moves;
 }
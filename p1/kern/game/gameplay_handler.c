@@ -10,36 +10,53 @@
 
 #include <mt19937int.h>
 #include "inc/game_controller.h"
-
-#define COLOR_CODE_MULTIPLIER 16
-
-char **grid;
+#include "inc/bitboard.h"
+#include "inc/solver.h"
+#include "inc/hint.h"
+#include "inc/region.h"
+
+/*Colors of the grid. The grid is a single static array sized for the
+  largest board, so starting a game does not allocate memory, and a row
+  is found by indexing rather than through a pointer*/
+char grid[MAX_BOARD_SIZE][MAX_BOARD_SIZE] __attribute__((aligned(64)));
 int curX, curY;
 int fill_count;
 unsigned int moves_count;
 unsigned int time_elapsed;
 
+/*Bitboards of the current board, and the flooded region on them, for
+  the solver and the hints. The region is tracked by region.c, and its
+  bitboard is built from the cells region.c adds to it*/
+bb_game board_bits;
+bitboard region_bits;
+
 int toggle = 1;
 
 /*Helper functions*/
-void allocate_grid(void);
-void deallocate_grid(void);
 void initialize_grid(void);
 void reset_variables(void);
 char get_random_color(void);
-int fill_color(char color);
 
 /**
  * @brief Function to initalize the data structures required
  * for the gameplay period and call the function to 
- * paint the gameplay screen.
+ * paint the gameplay screen. The moves allowed for the game are
+ * the moves the solver finds for the board.
  *
  * @Return Void
  */
 void start_gameplay() {
-	allocate_grid();
+	solver_result solved;
+
 	initialize_grid();
 	reset_variables();
+	fill_count = init_region(grid, cur_board_type);
+	bb_load(&board_bits, grid, cur_board_type, cur_color_count);
+	bb_clear(&region_bits);
+	bb_add_cells(&board_bits, &region_bits, region_cells, region_size);
+	solve_board(&board_bits, &region_bits, grid[0][0]/COLOR_CODE_MULTIPLIER,
+				SOLVER_BUDGET_NS, &solved);
+	set_max_moves(solved.moves);
 	sgenrand(num_ticks);
 	paint_game_screen(grid, cur_board_type, cur_board_type, cur_max_moves);
 }
@@ -67,7 +84,6 @@ void end_gameplay() {
 	int fill_percentage = (fill_count*100)/(cur_board_type*cur_board_type);
 	int success = ((moves_count<=cur_max_moves)&&(fill_percentage==100))?1:0;
 	add_score(time_elapsed, fill_percentage, success);
-	deallocate_grid();
 	reset_variables();
 	switch_to_end(success);
 }
@@ -77,7 +93,6 @@ void end_gameplay() {
  * to game_controller.c by displaying the title screen
  */
 void quit_gameplay() {
-	deallocate_grid();
 	reset_variables();
 	switch_to_title_screen();
 }
@@ -111,36 +126,6 @@ void reset_variables() {
 	time_elapsed = 0;
 }
 
-/**
- * @brief Allocates memory for the grid required for the
- * current game. Should be called by start_gameplay()
- *
- * @return Void
- */
-void allocate_grid() {
-	int i;
-	
-	grid = (char **)malloc(sizeof(char **)*cur_board_type);
-
-	for(i=0; i<cur_board_type; i++) {
-		grid[i] = (char *)malloc(sizeof(char)*cur_board_type);
-	}
-}
-
-/**
- * @brief Deallocates the memory allocated for the grid.
- * Should be called by end_gameplay()
- *
- * @return Void
- */
-void deallocate_grid() {
-	int i;	
-	for(i=0; i<cur_board_type; i++) {
-		free(grid[i]);
-	}
-	free(grid);
-}
-
 /**
  * @brief Function to return a random color. Used to populate the grid
  * when the game begins.
@@ -194,9 +179,9 @@ void handle_move(int direction) {
 /**
  * @brief Function to process the grid when a color is marked.
  * If the color marked is same as the current flood color, nothing
- * is done. Otherwise, the flood color is changed to the new color
- * using a breadth first traversal of the grid starting from the 
- * left top corner.
+ * is done. Otherwise, the flooded region is changed to the new color
+ * and grows into its frontier, and only the cells whose color changed
+ * are redrawn. The cells the region absorbed are added to its bitboard.
  *
  * @return Void
  */
@@ -205,75 +190,54 @@ void process_mark() {
 		return;
 	}
 	moves_count++;
-	fill_count = fill_color(grid[curX][curY]);
-	update_game_screen(grid, cur_board_type, cur_board_type, 
+	clear_hint_mark(grid, curX, curY);
+	int changed = flood_region(grid[curX][curY]);
+	bb_add_cells(&board_bits, &region_bits, region_cells + changed,
+				region_size - changed);
+	fill_count = region_size;
+	update_game_screen(grid, region_cells, changed,
 						time_elapsed, moves_count, cur_max_moves);
 
-	if(fill_count == (cur_board_type*cur_board_type) 
+	if(fill_count == cur_board_type*cur_board_type
 			|| moves_count>=cur_max_moves) {
 		end_gameplay();
 	}
 }
 
 /**
- * @brief Function to fill color recursively in the grid
- *
- * @param oldcolor Color to be replaced
- * @param newcolor New color to be filled
- * @param x x-coordinate of the grid to be filled
- * @param y y-coordinate of the grid to be filled
- * @param visited Character array to save visited cells in the grid
- * @param change 1-change color if possible; 0-Do not change color
+ * @brief Function to mark a cell of the color suggested for the next
+ * move. The suggestion is searched for within HINT_BUDGET_NS.
  *
- * @return Fill count
+ * @return Void
  */
-int fill_color_recursive(char oldcolor, char newcolor, int x, int y, 
-						char *visited, int change) {
-	if(x<0 || y<0 || x>=cur_board_type || y>=cur_board_type
-		|| (grid[x][y] != oldcolor && grid[x][y] != newcolor)) {
-		return 0;
-	}
-	int index = (x*cur_board_type)+y;
-	if((visited[index]) || (grid[x][y]==oldcolor && !change)) {
-		return 0;
-	}
-	if(grid[x][y] == newcolor) {
-		change = 0;
-	} else {
-		grid[x][y] = newcolor;
-		change = 1;
-	}
+void show_hint() {
+	int color, x, y;
 
-	visited[index] |= 1;
-	return 1+fill_color_recursive(oldcolor, newcolor, x+1, y, visited, change)+
-			fill_color_recursive(oldcolor, newcolor, x, y+1, visited, change)+
-			fill_color_recursive(oldcolor, newcolor, x-1, y, visited, change)+
-			fill_color_recursive(oldcolor, newcolor, x, y-1, visited, change);
-}
-
-/**
- * @brief Function to fill the color in the grid with the new color.
- *
- * @param color Color to be used to fill the grid
- *
- * @return int Count of the number of cells filled with the new color
- * in the grid.
- */
-int fill_color(char color) {
-	char *visited = (char *)calloc(cur_board_type*cur_board_type, 
-									sizeof(char));
-	int count = fill_color_recursive(grid[0][0], color, 0, 0, visited, 1);
-	free(visited);
-	return count;
+	clear_hint_mark(grid, curX, curY);
+	color = suggest_color(&board_bits, &region_bits,
+						grid[0][0]/COLOR_CODE_MULTIPLIER, HINT_BUDGET_NS);
+	if(color < 0 || !hint_cell(&board_bits, &region_bits, color, &x, &y)) {
+		return;
+	}
+	paint_hint(grid, x, y);
 }
 
 /**
  * @brief Function to increment the elapsed time. This function will
- * be called by the callback tick funtion in game_controller.c
+ * be called by the event loop in game_controller.c, every time the
+ * clock timer expires
  */
 void increment_time() {
 	time_elapsed++;
 	print_game_time(time_elapsed);
+}
+
+/**
+ * @brief Function to blink the current grid position. This function
+ * will be called by the event loop in game_controller.c, every time
+ * the blink timer expires
+ */
+void blink_selection() {
 	toggle_grid_selection(grid, curX, curY, toggle);
 	toggle = !toggle;
 }
@@ -0,0 +1,191 @@
+/**
+ * @file hint.c
+ * @brief Hints for the player of Flood-It. The color to play next is
+ * found with a beam search: the positions reached after each number of
+ * moves are scored, and only the best few are played on from. A
+ * position scores by the cells of its region, and then by the number
+ * of colors on its frontier, which are the choices it leaves for the
+ * moves after. The search uses static storage only, and stops when its
+ * time budget, measured with timer_ns(), runs out.
+ *
+ * @author Prajwal Yadapadithaya (pyadapad)
+ * @bug None
+ */
+
+#include "inc/hint.h"
+
+/*A position of the beam, and the first move on the way to it*/
+struct beam_entry {
+	bitboard region;
+	int color;
+	int first;
+	int score;
+};
+
+/*The beam of the current move, and the beam being built for the next*/
+static struct beam_entry beams[2][HINT_BEAM_WIDTH];
+
+/*Helper functions*/
+static int score_position(const bb_game *, const bitboard *, int);
+static int add_to_beam(const bb_game *, struct beam_entry *, int,
+						const struct beam_entry *);
+
+/**
+ * @brief Function to suggest the color to play next.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param color The color of the region
+ * @param budget_ns Time the search may take, in ns
+ *
+ * @return The color to play, or -1 if the board is flooded already
+ */
+int suggest_color(const bb_game *game, const bitboard *region, int color,
+					uint64_t budget_ns) {
+	uint64_t deadline = timer_ns() + budget_ns;
+	struct beam_entry *cur = beams[0], *next = beams[1], *swap;
+	struct beam_entry child;
+	bitboard frontier;
+	int count = 1, depth, i, c;
+
+	if(bb_flooded(game, region)) {
+		return -1;
+	}
+
+	cur[0].region = *region;
+	cur[0].color = color;
+	cur[0].first = -1;
+	cur[0].score = 0;
+
+	for(depth=0; depth<HINT_DEPTH; depth++) {
+		int next_count = 0;
+
+		for(i=0; i<count; i++) {
+			/*The first move is always searched in full, so that there
+			  is a color to suggest*/
+			if(depth > 0 && timer_ns() > deadline) {
+				return cur[0].first;
+			}
+
+			bb_frontier(game, &cur[i].region, &frontier);
+			for(c=0; c<game->colors; c++) {
+				if(c == cur[i].color ||
+						!bb_touches(game, &frontier, &game->color[c])) {
+					continue;
+				}
+				child.region = cur[i].region;
+				child.color = c;
+				child.first = (depth == 0) ? c : cur[i].first;
+				bb_play(game, &child.region, c);
+
+				/*The beam is searched a move at a time, so the first
+				  position found to flood the board is the soonest*/
+				if(bb_flooded(game, &child.region)) {
+					return child.first;
+				}
+				child.score = score_position(game, &child.region, c);
+				next_count = add_to_beam(game, next, next_count, &child);
+			}
+		}
+
+		swap = cur;
+		cur = next;
+		next = swap;
+		count = next_count;
+	}
+	return cur[0].first;
+}
+
+/**
+ * @brief Function to find the cell to be marked for a hint, which is a
+ * cell of the suggested color next to the region.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param color The suggested color
+ * @param x Set to the row of the cell
+ * @param y Set to the column of the cell
+ *
+ * @return 1 if there is such a cell, 0 otherwise
+ */
+int hint_cell(const bb_game *game, const bitboard *region, int color,
+				int *x, int *y) {
+	bitboard frontier;
+	int i, bit;
+
+	bb_frontier(game, region, &frontier);
+	for(i=0; i<game->words; i++) {
+		uint64_t w = frontier.w[i] & game->color[color].w[i];
+		if(w == 0) {
+			continue;
+		}
+		for(bit=0; !(w & 1); bit++) {
+			w >>= 1;
+		}
+		bit += i*64;
+		*x = bit/game->stride;
+		*y = bit%game->stride;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Function to score a position of the search.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param color The color of the region
+ *
+ * @return Score of the position, higher is better
+ */
+int score_position(const bb_game *game, const bitboard *region, int color) {
+	bitboard frontier;
+	int c, colors = 0;
+
+	bb_frontier(game, region, &frontier);
+	for(c=0; c<game->colors; c++) {
+		if(c != color && bb_touches(game, &frontier, &game->color[c])) {
+			colors++;
+		}
+	}
+	return bb_count(game, region)*HINT_AREA_WEIGHT + colors;
+}
+
+/**
+ * @brief Function to add a position to a beam, which is kept sorted by
+ * score, best first. The position is dropped if the beam is full of
+ * better positions, or if the beam already has the same region.
+ *
+ * @param game The board
+ * @param beam The beam
+ * @param count Number of positions in the beam
+ * @param entry The position to be added
+ *
+ * @return Number of positions in the beam after the addition
+ */
+int add_to_beam(const bb_game *game, struct beam_entry *beam, int count,
+				const struct beam_entry *entry) {
+	int i, j;
+
+	for(i=0; i<count; i++) {
+		if(beam[i].score == entry->score &&
+				bb_covers(game, &beam[i].region, &entry->region)) {
+			/*Regions of the same score have the same size*/
+			return count;
+		}
+	}
+
+	for(i=count; i>0 && beam[i-1].score < entry->score; i--);
+	if(i == HINT_BEAM_WIDTH) {
+		return count;
+	}
+	if(count < HINT_BEAM_WIDTH) {
+		count++;
+	}
+	for(j=count-1; j>i; j--) {
+		beam[j] = beam[j-1];
+	}
+	beam[i] = *entry;
+	return count;
+}
@@ -0,0 +1,62 @@
+/** @file bitboard.h
+ *  @brief Header file for bitboard.c
+ *
+ *  A board is kept as one bitmask per color. Bit x*stride + y stands
+ *  for the cell in row x and column y. The stride is one more than the
+ *  board size, so every row ends with a guard bit which is never set;
+ *  shifting a mask by one then cannot carry a cell into the next row.
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __bitboard_h
+#define __bitboard_h
+
+#include <stdint.h>
+#include "game_controller.h"
+
+/*Words needed for the largest board, guard bits included. The engine
+  works for any board size; only this needs to grow with it*/
+#define BB_WORDS ((MAX_BOARD_SIZE*(MAX_BOARD_SIZE+1) + 63)/64)
+
+/*A set of cells of the board*/
+typedef struct bitboard {
+	uint64_t w[BB_WORDS];
+} bitboard;
+
+/**
+ * The cells of each color of a board, as it was dealt. The cells
+ * outside the flooded region never change color, so these masks stay
+ * valid for the whole game, and a position is just its region.
+ */
+typedef struct bb_game {
+	int size; /*The board is size x size*/
+	int stride; /*Bits per row, including the guard bit*/
+	int words; /*Words of the bitboards in use*/
+	int colors; /*Number of colors*/
+	bitboard board; /*All the cells of the board*/
+	bitboard color[MAX_COLOR_COUNT]; /*Cells of each color*/
+} bb_game;
+
+void bb_load(bb_game *, char [][MAX_BOARD_SIZE], int, int);
+
+void bb_clear(bitboard *);
+
+void bb_add_cells(const bb_game *, bitboard *, const grid_cell *, int);
+
+int bb_play(const bb_game *, bitboard *, int);
+
+void bb_frontier(const bb_game *, const bitboard *, bitboard *);
+
+int bb_count(const bb_game *, const bitboard *);
+
+int bb_empty(const bb_game *, const bitboard *);
+
+int bb_touches(const bb_game *, const bitboard *, const bitboard *);
+
+int bb_covers(const bb_game *, const bitboard *, const bitboard *);
+
+int bb_flooded(const bb_game *, const bitboard *);
+
+#endif
@@ -0,0 +1,26 @@
+/** @file console_bench.h
+ *  @brief Header file for console_bench.c
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __console_bench_h
+#define __console_bench_h
+
+/*Characters printed by each printf() of the printf benchmark. Longer
+  than the buffer of printf(), so that it is flushed more than once*/
+#define BENCH_TEXT_LENGTH 2000
+
+/*Characters per line of the text, newline included*/
+#define BENCH_LINE_LENGTH 80
+
+/*Calls to printf() timed by the printf benchmark*/
+#define BENCH_PRINTF_RUNS 50
+
+/*Clears of the screen timed by the clear benchmark, each way*/
+#define BENCH_CLEAR_RUNS 200
+
+void console_benchmark(void);
+
+#endif
@@ -13,15 +13,42 @@
 #define BOARD_SIZE_COUNT 5
 #define COLOR_COUNT 5
 
+/*Largest board size in board_type. Can be raised at build time, up to
+  255, for example by the host benchmarks to play on larger boards*/
+#ifndef MAX_BOARD_SIZE
+#define MAX_BOARD_SIZE 14
+#endif
+
+/*Cells of the largest board*/
+#define MAX_CELLS (MAX_BOARD_SIZE*MAX_BOARD_SIZE)
+
+/*Largest number of colors in color_count*/
+#define MAX_COLOR_COUNT 8
+
+/*Colors of the grid are multiples of this, starting from 0*/
+#define COLOR_CODE_MULTIPLIER 16
+
 #define GAME_COUNT 5
 
-/*2D array to keep track of maximum moves allowed*/
-static const int max_moves[BOARD_SIZE_COUNT][COLOR_COUNT] = 
-	{{7, 8, 10, 12, 14},
-	{9, 11, 14, 16, 19},
-	{11, 14, 17, 20, 23},
-	{14, 17, 21, 25, 28},
-	{16, 20, 25, 29, 33}};
+/*Periods of the software timers of the game, in ms. They are converted
+  to ticks at the current rate of the timer with timer_ms_to_ticks()*/
+#define CLOCK_PERIOD_MS 1000
+#define BLINK_PERIOD_MS 1000
+
+/*Position of a cell in the grid*/
+typedef struct grid_cell {
+	unsigned char x, y;
+} grid_cell;
+
+/*Counters of the delta renderer of the gameplay screen*/
+typedef struct render_stats {
+	unsigned int updates; /*Moves rendered*/
+	unsigned int cells; /*Grid cells written for all the moves*/
+	unsigned int last_cells; /*Grid cells written for the last move*/
+	unsigned int max_cells; /*Most grid cells written for a move*/
+	unsigned int fields; /*Time and moves fields printed*/
+	unsigned int fields_skipped; /*Fields not printed, as unchanged*/
+} render_stats;
 
 /*Board type and color*/
 static const int board_type[BOARD_SIZE_COUNT] = {6, 8, 10, 12, 14};
@@ -47,7 +74,8 @@ enum SCREEN {
 	GAME_SCREEN,
 	PAUSE_SCREEN,
 	END_SCREEN,
-	INSTR_SCREEN
+	INSTR_SCREEN,
+	DEBUG_SCREEN
 };
 
 extern volatile enum SCREEN cur_screen;
@@ -59,19 +87,31 @@ void paint_color_sel_screen();
 void paint_pause_screen();
 void paint_end_screen(int);
 void paint_instr_screen();
-void paint_game_screen(char **, int, int, int);
-void update_game_screen(char **, int, int, unsigned int, int, int);
-void update_grid_position(char **, int, int, int, int);
-void toggle_grid_selection(char **, int, int, int);
+void paint_debug_screen(void);
+void paint_game_screen(char [][MAX_BOARD_SIZE], int, int, int);
+void update_game_screen(char [][MAX_BOARD_SIZE], const grid_cell *, int,
+						unsigned int, int, int);
+void update_grid_position(char [][MAX_BOARD_SIZE], int, int, int, int);
+void toggle_grid_selection(char [][MAX_BOARD_SIZE], int, int, int);
+void paint_hint(char [][MAX_BOARD_SIZE], int, int);
+void clear_hint_mark(char [][MAX_BOARD_SIZE], int, int);
 void print_game_moves(int, int);
 void print_game_time(int);
+void get_render_stats(render_stats *);
+void render_stats_dump(void);
 
 /*Key press handler*/
-void read_key_char();
+void handle_key(int);
 
 /*Timer callback*/
 void tick(unsigned int);
 
+/*Software timers of the game, identified by the data of their events*/
+enum GAME_TIMER {
+	CLOCK_TIMER, /*Updates the elapsed time*/
+	BLINK_TIMER /*Blinks the current grid position*/
+};
+
 /*Game initializer*/
 void initialize_game(void);
 
@@ -84,6 +124,7 @@ void switch_to_board_sel(void);
 void switch_to_color_sel(void);
 void switch_to_game(void);
 void switch_to_instr(void);
+void switch_to_debug(void);
 void switch_to_pause(void);
 void switch_to_end(int);
 void resume_game(void);
@@ -94,7 +135,7 @@ void add_score(unsigned int, unsigned int, int);
 /*Value set functions*/
 void set_board_type(int);
 void set_color_count(int);
-void set_max_moves(void);
+void set_max_moves(int);
 
 /*Game play functions*/
 void start_gameplay(void);
@@ -103,6 +144,8 @@ void end_gameplay(void);
 void quit_gameplay(void);
 void handle_move(int);
 void process_mark(void);
+void show_hint(void);
 void increment_time(void);
+void blink_selection(void);
 
 #endif
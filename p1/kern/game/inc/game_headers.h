@@ -29,4 +29,12 @@
 
 #include <string.h>
 
+/* driver includes */
+#include <drivers/inc/console_driver.h>   /* console_set_buffered() */
+#include <drivers/inc/keyboard_driver.h>  /* readchar() */
+#include <drivers/inc/event_queue.h>     /* wait_event() */
+#include <drivers/inc/timer_driver.h>    /* timer_set_tickless() */
+#include <drivers/inc/timer_wheel.h>     /* soft_timer_start() */
+#include <drivers/inc/irq.h>             /* irq_get_stats() */
+
 #endif
@@ -27,6 +27,7 @@ const char *str_author = "Game by Prajwal Yadapadithaya (pyadapad)";
 const char *str_last5 = "Last 5 games";
 const char *str_start = "g - Begin game";
 const char *str_help = "h - Help";
+const char *str_debug = "i - Interrupt statistics";
 
 /*Selection screen strings*/
 const char *str_choose_board = "Choose the board size for the game.";
@@ -38,6 +39,7 @@ const char *str_game_move = "wasd = move";
 const char *str_game_mark = "space = mark";
 const char *str_game_pause = "p = pause";
 const char *str_game_help = "h = help";
+const char *str_game_hint = "n = hint";
 const char *str_game_quit = "q = quit";
 
 /*Pause screen strings*/
@@ -49,6 +51,12 @@ const char *str_win = "Yay! You won :)";
 const char *str_lose = "You lost :(";
 const char *str_start_over = "Type 't' to go to the main screen";
 
+/*Debug screen strings*/
+const char *str_debug_title = "Interrupt statistics";
+const char *str_debug_header = "IRQ      Count  Spurious  Max cycles  Avg cycles";
+const char *str_debug_log = "l : log profiles, c : benchmark the console (Simics console)";
+const char *str_debug_back = "b : back to the previous screen";
+
 /*Help screen strings*/
 const char *str_instr[] = {
 		"Welcome to Flood-It. The rules of the game are listed below.",
@@ -58,6 +66,7 @@ const char *str_instr[] = {
 		"the given number of moves, you win the game. Else, you lose.",
 		"Use wasd keys to move the selection cell in the board.",
 		"Use space key to fill the board with a particular color.",
+		"Use n key to mark a cell of the color to play next with a *.",
 		"b : back to the previous screen"};
 
 #endif
@@ -0,0 +1,31 @@
+/** @file hint.h
+ *  @brief Header file for hint.c
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __hint_h
+#define __hint_h
+
+#include <stdint.h>
+#include "bitboard.h"
+
+/*Time a hint may take, in ns. Well within a frame of the screen*/
+#define HINT_BUDGET_NS 4000000
+
+/*Positions kept at each move of the beam search*/
+#define HINT_BEAM_WIDTH 8
+
+/*Moves the beam search looks ahead*/
+#define HINT_DEPTH 8
+
+/*Weight of a cell of the region against a color of the frontier, in
+  the score of a position*/
+#define HINT_AREA_WEIGHT 8
+
+int suggest_color(const bb_game *, const bitboard *, int, uint64_t);
+
+int hint_cell(const bb_game *, const bitboard *, int, int *, int *);
+
+#endif
@@ -0,0 +1,21 @@
+/** @file region.h
+ *  @brief Header file for region.c
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __region_h
+#define __region_h
+
+#include "game_controller.h"
+
+/*Cells of the flooded region, in the order they joined it*/
+extern grid_cell region_cells[MAX_CELLS];
+extern int region_size;
+
+int init_region(char [][MAX_BOARD_SIZE], int);
+
+int flood_region(char);
+
+#endif
@@ -0,0 +1,34 @@
+/** @file solver.h
+ *  @brief Header file for solver.c
+ *
+ *  @author Prajwal Yadapadithaya (pyadapad)
+ *  @bug None
+ */
+
+#ifndef __solver_h
+#define __solver_h
+
+#include <stdint.h>
+#include "bitboard.h"
+
+/*Time the solver may spend on a board at the start of a game, in ns.
+  The greedy solution is always completed; past the budget it plays
+  without looking ahead, so it only overruns by a play per color and
+  move*/
+#define SOLVER_BUDGET_NS 3000000
+
+/*Moves of the greedy solver which are looked ahead*/
+#define SOLVER_LOOKAHEAD 2
+
+/*Result of solving a board*/
+typedef struct solver_result {
+	int moves; /*Moves of the shortest solution found*/
+	int optimal; /*1 if no solution is shorter*/
+	unsigned int nodes; /*Positions searched by the exact search*/
+	uint64_t ns; /*Time spent*/
+} solver_result;
+
+void solve_board(const bb_game *, const bitboard *, int, uint64_t,
+				solver_result *);
+
+#endif
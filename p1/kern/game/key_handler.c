@@ -1,14 +1,14 @@
 /** @file key_handler.c
  *  @brief Key press handler for the game Flood it.
- *  Reads the characters from the keyboard buffer, and
- *  depending the current screen of the game, handles
- *  them appropriately.
+ *  Handles the characters read from the keyboard buffer
+ *  appropriately, depending the current screen of the game.
  *
  *  @author Prajwal Yadapadithaya (pyadapad)
  *  @bug
  */
 
 #include "inc/game_controller.h"
+#include "inc/console_bench.h"
 
 /*Key handler functions*/
 static void handle_asdw(int);
@@ -21,6 +21,10 @@ static void handle_r();
 static void handle_h();
 static void handle_t();
 static void handle_b();
+static void handle_i();
+static void handle_l();
+static void handle_n();
+static void handle_c();
 
 /*Other helper functions*/
 static void set_board_type_and_switch(int);
@@ -28,96 +32,110 @@ static void set_color_count_and_switch(int);
 
 /**
  * @brief Key press handler for Flood-It
- * Reads the user input (an input character) and
- * calls the associated function with the particular
- * key.
+ * Calls the associated function with the particular
+ * key, depending on the current screen. Called by the
+ * event loop in game_controller.c for every key read.
+ *
+ * @param ch The character read from the keyboard
  *
  * @retun Void
  */
-void read_key_char() {
+void handle_key(int ch) {
+	//lprintf("%c", ch);
+	//Handle various operations
+	switch(ch) {
+		case 'A':
+		case 'a':
+			handle_asdw(1);
+			break;
+		case 'S':
+		case 's':
+			handle_asdw(4);
+			break;
+		case 'W':
+		case 'w':
+			handle_asdw(3);
+			break;
+		case 'D':
+		case 'd':
+			handle_asdw(2);
+			break;
 
-	while(1) {
-		int ch = readchar();
-		if(ch == -1) {
-			continue;
-		}
+		case ' ':
+			handle_mark();
+			break;
 
-		//lprintf("%c", ch);
-		//Handle various operations
-		switch(ch) {
-			case 'A':
-			case 'a':
-				handle_asdw(1);
-				break;
-			case 'S':
-			case 's':
-				handle_asdw(4);
-				break;
-			case 'W':
-			case 'w':
-				handle_asdw(3);
-				break;
-			case 'D':
-			case 'd':
-				handle_asdw(2);
-				break;
+		case '1':
+			handle_selection(0);
+			break;
+		case '2':
+			handle_selection(1);
+			break;
+		case '3':
+			handle_selection(2);
+			break;
+		case '4':
+			handle_selection(3);
+			break;
+		case '5':
+			handle_selection(4);
+			break;
 
-			case ' ':
-				handle_mark();
-				break;
+		case 'G':
+		case 'g':
+			handle_g();
+			break;
+		case 'P':
+		case 'p':
+			handle_p();
+			break;
+		case 'R':
+		case 'r':
+			handle_r();
+			break;
 
-			case '1':
-				handle_selection(0);
-				break;
-			case '2':
-				handle_selection(1);
-				break;
-			case '3':
-				handle_selection(2);
-				break;
-			case '4':
-				handle_selection(3);
-				break;
-			case '5':
-				handle_selection(4);
-				break;
+		case 'Q':
+		case 'q':
+			handle_q();
+			break;
 
-			case 'G':
-			case 'g':
-				handle_g();
-				break;
-			case 'P':
-			case 'p':
-				handle_p();
-				break;
-			case 'R':
-			case 'r':
-				handle_r();
-				break;
+		case 'B':
+		case 'b':
+			handle_b();
+			break;
 
-			case 'Q':
-			case 'q':
-				handle_q();
-				break;
+		case 'T':
+		case 't':
+			handle_t();
+			break;
 	
-			case 'B':
-			case 'b':
-				handle_b();
-				break;
+		case 'H':
+		case 'h':
+			handle_h();
+			break;
+
+		case 'I':
+		case 'i':
+			handle_i();
+			break;
 
-			case 'T':
-			case 't':
-				handle_t();
-				break;
-		
-			case 'H':
-			case 'h':
-				handle_h();
-				break;
+		case 'L':
+		case 'l':
+			handle_l();
+			break;
+
+		case 'N':
+		case 'n':
+			handle_n();
+			break;
 
-			default: 
-				break;
-		}
+		case 'C':
+		case 'c':
+			handle_c();
+			break;
+
+		default: 
+			break;
 	}
 }
 
@@ -235,14 +253,73 @@ void handle_h() {
 	switch_to_instr();
 }
 
+/**
+ * @brief Function to handle showing the interrupt statistics.
+ * Invoked by pressing 'i' from the title screen.
+ *
+ * @return Void
+ */
+void handle_i() {
+	if(cur_screen != TITLE_SCREEN) {
+		return;
+	}
+	set_previous_screen(cur_screen);
+	switch_to_debug();
+}
+
+/**
+ * @brief Function to handle press of 'l' in the interrupt
+ * statistics screen, which writes the profile of the interrupt
+ * handlers and the counters of the renderer to the Simics console.
+ *
+ * @return Void
+ */
+void handle_l() {
+	if(cur_screen != DEBUG_SCREEN) {
+		return;
+	}
+	irq_profile_dump();
+	render_stats_dump();
+}
+
+/**
+ * @brief Function to handle press of 'n' in the gameplay screen,
+ * which marks a cell of the color suggested for the next move.
+ *
+ * @return Void
+ */
+void handle_n() {
+	if(cur_screen != GAME_SCREEN) {
+		return;
+	}
+	show_hint();
+}
+
+/**
+ * @brief Function to handle press of 'c' in the interrupt
+ * statistics screen, which runs the benchmarks of the console and
+ * writes their results to the Simics console. The screen is painted
+ * again afterwards.
+ *
+ * @return Void
+ */
+void handle_c() {
+	if(cur_screen != DEBUG_SCREEN) {
+		return;
+	}
+	console_benchmark();
+	paint_debug_screen();
+}
+
 /**
  * @brief Function to handle press of 'b' button. Used from the 
- * instruction screen to go back to the previous screen.
+ * instruction and interrupt statistics screens to go back to the
+ * previous screen.
  *
  * @return Void
  */
 void handle_b() {
-	if(cur_screen != INSTR_SCREEN) {
+	if(cur_screen != INSTR_SCREEN && cur_screen != DEBUG_SCREEN) {
 		return;
 	}
 	restore_previous_screen();
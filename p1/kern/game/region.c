@@ -0,0 +1,210 @@
+/**
+ * @file region.c
+ * @brief The flooded region of a Flood-It board, kept across the moves
+ * of a game. A move recolors the region and absorbs the cells of the
+ * new color which are connected to it, with an iterative scanline flood
+ * fill seeded from the frontier of the region. The fill uses a stack of
+ * fixed size rather than recursion, so that its depth does not grow
+ * with the region on the small kernel stack.
+ *
+ * @author Prajwal Yadapadithaya (pyadapad)
+ * @bug None
+ */
+
+#include <string.h>
+#include "inc/region.h"
+
+/**
+ * The flooded region, which is kept across moves. The region is the
+ * list of its cells, in the order they joined it. The frontier is the
+ * cells next to the region, but not in it, kept in one list per color.
+ * A cell is in the region (or the frontier) if its stamp is the
+ * generation of the current game, so the stamps do not need to be
+ * cleared between games.
+ */
+grid_cell region_cells[MAX_CELLS];
+int region_size;
+static grid_cell frontier[MAX_COLOR_COUNT][MAX_CELLS];
+static int frontier_size[MAX_COLOR_COUNT];
+static unsigned int region_stamps[MAX_CELLS];
+static unsigned int frontier_stamps[MAX_CELLS];
+static unsigned int region_generation = 0;
+
+/*Stack of the cells from which the flood fill still has to scan. Every
+  cell is pushed at most once*/
+static grid_cell fill_stack[MAX_CELLS];
+
+/*The board the region is on*/
+static char (*region_grid)[MAX_BOARD_SIZE];
+static int region_board_size;
+
+/*Helper functions*/
+static void absorb_cells(char color, int top);
+static void add_to_frontier(int x, int y);
+
+/**
+ * @brief Function to start tracking the flooded region of a new
+ * board. The region starts as the cells connected to the left top
+ * corner with the same color as it.
+ *
+ * @param grid 2D array containing the grid colors. The region keeps
+ * the colors of its cells up to date in it
+ * @param size Length and height of the grid
+ *
+ * @return Number of cells in the region
+ */
+int init_region(char grid[][MAX_BOARD_SIZE], int size) {
+	int i;
+
+	region_grid = grid;
+	region_board_size = size;
+
+	if(++region_generation == 0) {
+		/*The stamps have wrapped around, clear them*/
+		memset(region_stamps, 0, sizeof(region_stamps));
+		memset(frontier_stamps, 0, sizeof(frontier_stamps));
+		region_generation = 1;
+	}
+	region_size = 0;
+	for(i=0; i<MAX_COLOR_COUNT; i++) {
+		frontier_size[i] = 0;
+	}
+
+	fill_stack[0].x = 0;
+	fill_stack[0].y = 0;
+	region_stamps[0] = region_generation;
+	absorb_cells(grid[0][0], 1);
+	return region_size;
+}
+
+/**
+ * @brief Function to flood the region with a new color. The cells of
+ * the region are recolored, and the frontier cells of the new color
+ * are absorbed into the region, along with the cells of the same color
+ * connected to them. The cost is proportional to the size of the
+ * region and the number of cells absorbed; the rest of the board is
+ * not looked at.
+ *
+ * @param color The new color. Must not be the color of the region
+ *
+ * @return Number of cells whose color changed. These are the first
+ * cells of region_cells.
+ */
+int flood_region(char color) {
+	char (*grid)[MAX_BOARD_SIZE] = region_grid;
+	int changed = region_size;
+	int bucket = color/COLOR_CODE_MULTIPLIER;
+	int i, top = 0;
+
+	for(i=0; i<changed; i++) {
+		grid[region_cells[i].x][region_cells[i].y] = color;
+	}
+
+	/*Seed the fill with the frontier cells of the new color. A cell
+	  can already be in the region if it was absorbed through another
+	  frontier cell, so it is stamped when pushed*/
+	for(i=0; i<frontier_size[bucket]; i++) {
+		grid_cell cell = frontier[bucket][i];
+		int index = cell.x*region_board_size + cell.y;
+		if(region_stamps[index] != region_generation) {
+			region_stamps[index] = region_generation;
+			fill_stack[top++] = cell;
+		}
+	}
+	frontier_size[bucket] = 0;
+
+	absorb_cells(color, top);
+	return changed;
+}
+
+/**
+ * @brief Function to absorb into the region the cells of a color
+ * connected to the seeds on the fill stack. The fill is iterative: it
+ * absorbs a whole run of a row at a time, and pushes one cell of every
+ * run of matching cells in the rows above and below on a stack of
+ * fixed size. A cell is stamped when it is pushed or absorbed, so it
+ * is never pushed twice. The neighbors of the absorbed cells which
+ * have other colors are added to the frontier.
+ *
+ * @param color Color of the cells to be absorbed
+ * @param top Number of seeds on the fill stack. The seeds must be
+ * stamped already
+ *
+ * @return Void
+ */
+void absorb_cells(char color, int top) {
+	char (*grid)[MAX_BOARD_SIZE] = region_grid;
+	int n = region_board_size;
+	unsigned int gen = region_generation;
+	int x, y, l, r, row;
+
+	while(top > 0) {
+		top--;
+		x = fill_stack[top].x;
+		y = fill_stack[top].y;
+
+		/*Extend the run of the seed to the left and to the right*/
+		for(l = y; l > 0 && region_stamps[x*n + l-1] != gen &&
+				grid[x][l-1] == color; l--);
+		for(r = y; r < n-1 && region_stamps[x*n + r+1] != gen &&
+				grid[x][r+1] == color; r++);
+		for(y = l; y <= r; y++) {
+			region_stamps[x*n + y] = gen;
+			region_cells[region_size].x = x;
+			region_cells[region_size++].y = y;
+		}
+		add_to_frontier(x, l-1);
+		add_to_frontier(x, r+1);
+
+		/*Push a seed for every run of the rows above and below*/
+		for(row = x-1; row <= x+1; row += 2) {
+			if(row < 0 || row >= n) {
+				continue;
+			}
+			int in_run = 0;
+			for(y = l; y <= r; y++) {
+				int index = row*n + y;
+				if(region_stamps[index] == gen) {
+					in_run = 0;
+				} else if(grid[row][y] != color) {
+					add_to_frontier(row, y);
+					in_run = 0;
+				} else if(!in_run) {
+					region_stamps[index] = gen;
+					fill_stack[top].x = row;
+					fill_stack[top++].y = y;
+					in_run = 1;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Function to add a cell next to the region to the frontier,
+ * unless it is off the board, in the region, or already in the
+ * frontier. The frontier is kept by color, so that a move only looks
+ * at the frontier cells of its color.
+ *
+ * @param x x-coordinate of the cell
+ * @param y y-coordinate of the cell
+ *
+ * @return Void
+ */
+void add_to_frontier(int x, int y) {
+	int n = region_board_size;
+
+	if(x < 0 || y < 0 || x >= n || y >= n) {
+		return;
+	}
+	int index = x*n + y;
+	if(region_stamps[index] == region_generation ||
+			frontier_stamps[index] == region_generation) {
+		return;
+	}
+
+	int bucket = region_grid[x][y]/COLOR_CODE_MULTIPLIER;
+	frontier_stamps[index] = region_generation;
+	frontier[bucket][frontier_size[bucket]].x = x;
+	frontier[bucket][frontier_size[bucket]++].y = y;
+}
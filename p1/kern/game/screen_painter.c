@@ -16,12 +16,29 @@
 
 #define SPACE ' '
 
+/*Character marking the cell of a hint*/
+#define HINT_MARK '*'
+
+/*Values shown in the time and moves fields of the gameplay screen, -1
+  when the field has to be printed again*/
+static int shown_time = -1;
+static int shown_moves = -1, shown_maxmoves = -1;
+
+/*Counters of the delta renderer of the gameplay screen*/
+static render_stats render;
+
+/*Cell marked with a hint. The mark is drawn again whenever the
+  selection is drawn over the cell. hint_row is -1 when no cell is
+  marked*/
+static int hint_row = -1, hint_col;
+
 /*Helper functions*/
 static void print_last5(int);
 static void print_grid_boundary(int, int);
-static void print_grid(char **, int, int);
-static void set_grid_selection(char **, int, int);
-static void unset_grid_selection(char **, int, int);
+static void print_grid(char [][MAX_BOARD_SIZE], int, int);
+static void set_grid_selection(char [][MAX_BOARD_SIZE], int, int);
+static void unset_grid_selection(char [][MAX_BOARD_SIZE], int, int);
+static void draw_grid_cell(char [][MAX_BOARD_SIZE], int, int, int);
 static void print_game_info(void);
 
 /**
@@ -55,6 +72,8 @@ void paint_title_screen() {
 	printf("%s", str_start);
 	set_cursor(row+5, col);
 	printf("%s", str_help);
+	set_cursor(row+6, col);
+	printf("%s", str_debug);
 
 	print_last5(row+4);
 
@@ -151,8 +170,12 @@ void paint_color_sel_screen() {
  *
  * @return Void
  */
-void paint_game_screen(char **grid, int length, int height, int maxmoves) {
+void paint_game_screen(char grid[][MAX_BOARD_SIZE], int length, int height,
+						int maxmoves) {
 	clear_console();
+	shown_time = -1;
+	shown_moves = -1;
+	hint_row = -1;
 	print_grid_boundary(length+1, height);
 	print_grid(grid, length, height);
 	set_grid_selection(grid, 0, 0);
@@ -163,25 +186,66 @@ void paint_game_screen(char **grid, int length, int height, int maxmoves) {
 
 /**
  * @brief Function to update the gameplay screen with new data
- * in the grid. Also update the game progress details such as time
- * and number of moves.
+ * in the grid. Only the cells whose color changed are redrawn. Also
+ * update the game progress details such as time and number of moves,
+ * if they changed. The cells written are counted in the render stats.
  *
  * @param grid 2D array containing the grid colors
- * @param length Length of the grid
- * @param height Height of the grid
+ * @param changed Cells whose color changed
+ * @param count Number of cells in changed
  * @param time Time elapsed so far in the current game
  * @param moves Number of moves performed in the current game
  * @param maxmoves Maximum number of moves allowed for the game
  *
  * @return Void
  */
-void update_game_screen(char **grid, int length, int height, 
-						unsigned int time, int moves, int maxmoves) {
-	print_grid(grid, length, height);
+void update_game_screen(char grid[][MAX_BOARD_SIZE], const grid_cell *changed,
+						int count, unsigned int time, int moves, int maxmoves) {
+	int i;
+
+	for(i=0; i<count; i++) {
+		draw_char(GRID_TOP_MARGIN+changed[i].x, GRID_LEFT_MARGIN+changed[i].y,
+					SPACE, grid[changed[i].x][changed[i].y]);
+	}
+	render.updates++;
+	render.cells += count;
+	render.last_cells = count;
+	if((unsigned int)count > render.max_cells) {
+		render.max_cells = count;
+	}
+
 	print_game_time(time);
 	print_game_moves(moves, maxmoves);
 }
 
+/**
+ * @brief Function to get the counters of the delta renderer of the
+ * gameplay screen.
+ *
+ * @param stats Set to the counters
+ *
+ * @return Void
+ */
+void get_render_stats(render_stats *stats) {
+	*stats = render;
+}
+
+/**
+ * @brief Function to write the counters of the delta renderer to the
+ * Simics console.
+ *
+ * @return Void
+ */
+void render_stats_dump() {
+	unsigned int avg = render.updates ? render.cells/render.updates : 0;
+
+	lprintf("Render: %u moves, %u cells written (avg %u, max %u, last %u)",
+			render.updates, render.cells, avg, render.max_cells,
+			render.last_cells);
+	lprintf("Render: %u fields printed, %u unchanged fields skipped",
+			render.fields, render.fields_skipped);
+}
+
 /**
  * @brief Function to update the current selection in the grid.
  * This function restores the color of the previous selection in
@@ -194,7 +258,7 @@ void update_game_screen(char **grid, int length, int height,
  *
  * @return Void
  */
-void update_grid_position(char **grid, int oldX, int oldY, 
+void update_grid_position(char grid[][MAX_BOARD_SIZE], int oldX, int oldY, 
 							int newX, int newY) {
 	unset_grid_selection(grid, oldX, oldY);
 	set_grid_selection(grid, newX, newY);
@@ -210,35 +274,30 @@ void update_grid_position(char **grid, int oldX, int oldY,
  */
 void print_grid_boundary(int length, int height) {
 
-	int i;
-
-	set_cursor(GRID_TOP_MARGIN-1, GRID_LEFT_MARGIN);
-	printf("+");
-	set_cursor(GRID_TOP_MARGIN-1, GRID_LEFT_MARGIN+length);
-	printf("+");
-	set_cursor(GRID_TOP_MARGIN+height, GRID_LEFT_MARGIN);
-	printf("+");
-	set_cursor(GRID_TOP_MARGIN+height, GRID_LEFT_MARGIN+length);
-	printf("+");
-
-	for(i=GRID_TOP_MARGIN; i<GRID_TOP_MARGIN+height; i++) {
-		set_cursor(i, GRID_LEFT_MARGIN);
-		printf("|");
-		set_cursor(i, GRID_LEFT_MARGIN+length);
-		printf("|");
-	}
-
-	for(i=GRID_LEFT_MARGIN+1; i<GRID_LEFT_MARGIN+length; i++) {
-		set_cursor(GRID_TOP_MARGIN-1, i);
-		printf("-");
-		set_cursor(GRID_TOP_MARGIN+height, i);
-		printf("-");
-	}
-
+	int color;
+	get_term_color(&color);
+
+	/*The boundary is drawn one column to the left of the cursor 
+	  positions it used to be printed at, as set_cursor() does*/
+	int top = GRID_TOP_MARGIN-1;
+	int bottom = GRID_TOP_MARGIN+height;
+	int left = GRID_LEFT_MARGIN-1;
+	int right = GRID_LEFT_MARGIN+length-1;
+
+	draw_rect(top, left+1, length-1, 1, '-', color);
+	draw_rect(bottom, left+1, length-1, 1, '-', color);
+	draw_rect(top+1, left, 1, height, '|', color);
+	draw_rect(top+1, right, 1, height, '|', color);
+
+	draw_char(top, left, '+', color);
+	draw_char(top, right, '+', color);
+	draw_char(bottom, left, '+', color);
+	draw_char(bottom, right, '+', color);
 }
 
 /**
  * @brief Function to paint the grid insite the grid boundary.
+ * Each row of the grid is copied to the console in one go.
  *
  * @param grid 2D array containing the color of each cell in the grid
  * @param length Length of the grid
@@ -246,13 +305,14 @@ void print_grid_boundary(int length, int height) {
  *
  * @return Void
  */
-void print_grid(char **grid, int length, int height) {
+void print_grid(char grid[][MAX_BOARD_SIZE], int length, int height) {
 	int i, j;
-	for(i=GRID_TOP_MARGIN; i<GRID_TOP_MARGIN+height; i++) {
-		for(j=GRID_LEFT_MARGIN; j<GRID_LEFT_MARGIN+length; j++) {
-			draw_char(i, j, SPACE,
-					grid[i-GRID_TOP_MARGIN][j-GRID_LEFT_MARGIN]);
+	uint16_t cells[SCREEN_WIDTH];
+	for(i=0; i<height; i++) {
+		for(j=0; j<length; j++) {
+			cells[j] = CONSOLE_CELL(SPACE, grid[i][j]);
 		}
+		blit_cells(GRID_TOP_MARGIN+i, GRID_LEFT_MARGIN, length, 1, cells);
 	}
 }
 
@@ -268,7 +328,8 @@ void print_grid(char **grid, int length, int height) {
  *
  * @return Void
  */
-void toggle_grid_selection(char **grid, int x, int y, int set) {
+void toggle_grid_selection(char grid[][MAX_BOARD_SIZE], int x, int y,
+							int set) {
 	if(set) {
 		set_grid_selection(grid, x, y);
 	} else {
@@ -285,8 +346,8 @@ void toggle_grid_selection(char **grid, int x, int y, int set) {
  *
  * @return Void
  */
-void set_grid_selection(char **grid, int x, int y) {
-	draw_char(GRID_TOP_MARGIN+x, GRID_LEFT_MARGIN+y, SPACE, grid[x][y]|BLINK);
+void set_grid_selection(char grid[][MAX_BOARD_SIZE], int x, int y) {
+	draw_grid_cell(grid, x, y, BLINK);
 }
 
 /**
@@ -298,13 +359,75 @@ void set_grid_selection(char **grid, int x, int y) {
  *
  * @return Void
  */
-void unset_grid_selection(char **grid, int x, int y) {
-	draw_char(GRID_TOP_MARGIN+x, GRID_LEFT_MARGIN+y, SPACE, grid[x][y]);
+void unset_grid_selection(char grid[][MAX_BOARD_SIZE], int x, int y) {
+	draw_grid_cell(grid, x, y, 0);
+}
+
+/**
+ * @brief Function to draw a cell of the grid, with the mark of the
+ * hint if it is the cell of the hint.
+ *
+ * @param grid 2D array containing the color of each cell in the grid
+ * @param x Value of row in the grid
+ * @param y Value of column in the grid
+ * @param blink BLINK to draw the cell blinking, 0 otherwise
+ *
+ * @return Void
+ */
+void draw_grid_cell(char grid[][MAX_BOARD_SIZE], int x, int y, int blink) {
+	if(x == hint_row && y == hint_col) {
+		draw_char(GRID_TOP_MARGIN+x, GRID_LEFT_MARGIN+y, HINT_MARK,
+					grid[x][y]|FGND_WHITE|blink);
+	} else {
+		draw_char(GRID_TOP_MARGIN+x, GRID_LEFT_MARGIN+y, SPACE,
+					grid[x][y]|blink);
+	}
+}
+
+/**
+ * @brief Function to mark the cell of a hint in the grid. The mark
+ * stays on the cell when the selection moves over it or blinks, until
+ * it is cleared.
+ *
+ * @param grid 2D array containing the grid colors
+ * @param x Row of the cell
+ * @param y Column of the cell
+ *
+ * @return Void
+ */
+void paint_hint(char grid[][MAX_BOARD_SIZE], int x, int y) {
+	hint_row = x;
+	hint_col = y;
+	draw_grid_cell(grid, x, y, 0);
+}
+
+/**
+ * @brief Function to remove the mark of a hint from the grid. The
+ * cell of the current selection is left to the blinking, which draws
+ * it again without the mark.
+ *
+ * @param grid 2D array containing the grid colors
+ * @param selX Row of the current selection
+ * @param selY Column of the current selection
+ *
+ * @return Void
+ */
+void clear_hint_mark(char grid[][MAX_BOARD_SIZE], int selX, int selY) {
+	int x = hint_row, y = hint_col;
+
+	if(x < 0) {
+		return;
+	}
+	hint_row = -1;
+	if(x != selX || y != selY) {
+		draw_grid_cell(grid, x, y, 0);
+	}
 }
 
 /**
  * @brief Function to print the number of moves
- * performed so far in the game
+ * performed so far in the game. Nothing is printed if the
+ * numbers shown are the same.
  *
  * @param moves Number of moves performed so far
  * @param maxmoves Maximum number of moves allowed for the game
@@ -314,6 +437,14 @@ void unset_grid_selection(char **grid, int x, int y) {
 void print_game_moves(int moves, int maxmoves) {	
 	int row = SCREEN_HEIGHT/3;
 	int col = (2*SCREEN_WIDTH)/3;
+
+	if(moves == shown_moves && maxmoves == shown_maxmoves) {
+		render.fields_skipped++;
+		return;
+	}
+	shown_moves = moves;
+	shown_maxmoves = maxmoves;
+	render.fields++;
 	
 	set_cursor(row+1, col);
 	printf("Moves = %d/%d", moves, maxmoves);
@@ -321,7 +452,8 @@ void print_game_moves(int moves, int maxmoves) {
 
 /**
  * @brief Function to print the time elapsed so far
- * performed so far in the game
+ * performed so far in the game. Nothing is printed if the
+ * time shown is the same.
  *
  * @param time Time elapsed in the game so far.
  *
@@ -330,6 +462,13 @@ void print_game_moves(int moves, int maxmoves) {
 void print_game_time(int time) {
 	int row = SCREEN_HEIGHT/3;
 	int col = (2*SCREEN_WIDTH)/3;
+
+	if(time == shown_time) {
+		render.fields_skipped++;
+		return;
+	}
+	shown_time = time;
+	render.fields++;
 	
 	set_cursor(row, col);
 	printf("Time elapsed = %d:%02d", (time/60), (time%60));
@@ -356,8 +495,11 @@ void print_game_info() {
 
 	set_cursor(row+5, col);
 	printf("%s", str_game_help);
-	
+
 	set_cursor(row+6, col);
+	printf("%s", str_game_hint);
+	
+	set_cursor(row+7, col);
 	printf("%s", str_game_quit);
 }
 
@@ -408,6 +550,59 @@ void paint_end_screen(int success) {
 	printf("%s", str_start_over);
 }
 
+/**
+ * @brief Function to print the statistics of the interrupt lines,
+ * the number of events and keys dropped so far, how long keys wait
+ * to be read, and how the bottom half of the timer runs.
+ *
+ * @return Void
+ */
+void paint_debug_screen() {
+	clear_console();
+	int row = SCREEN_HEIGHT/8 - 1;
+	int col = SCREEN_WIDTH/5;
+
+	set_cursor(row++, col);
+	printf("%s", str_debug_title);
+	set_cursor(row++, col);
+	printf("%s", str_debug_header);
+
+	int irq;
+	irq_stats stats;
+	for(irq=0; irq<IRQ_COUNT; irq++) {
+		irq_get_stats(irq, &stats);
+		unsigned int avg = 0;
+		if(stats.count != 0) {
+			avg = stats.total_cycles/stats.count;
+		}
+		set_cursor(row++, col);
+		printf("%3d %10u %9u %11u %11u", irq, stats.count, stats.spurious,
+				(unsigned int)stats.max_cycles, avg);
+	}
+
+	set_cursor(row++, col);
+	printf("Events dropped: %u  Keys dropped: %u", events_dropped(),
+			keyboard_dropped_keys());
+
+	unsigned int keys;
+	uint64_t total, max;
+	keyboard_latency(&keys, &total, &max);
+	set_cursor(row++, col);
+	printf("Key latency: avg %u us, max %u us",
+			(unsigned int)(timer_cycles_to_ns(keys ? total/keys : 0)/1000),
+			(unsigned int)(timer_cycles_to_ns(max)/1000));
+
+	irq_get_stats(TIMER_IRQ, &stats);
+	set_cursor(row++, col);
+	printf("Timer bottom half: %u runs, %u deferred, max %u cycles",
+			stats.bh_runs, stats.bh_deferred,
+			(unsigned int)stats.bh_max_cycles);
+	set_cursor(row++, col);
+	printf("%s", str_debug_log);
+	set_cursor(row, col);
+	printf("%s", str_debug_back);
+}
+
 /**
  * @brief Function to print the instructions of the game.
  *
@@ -419,7 +614,7 @@ void paint_instr_screen() {
     int col = SCREEN_WIDTH/5;
 
 	int i;
-	for(i=0; i<8; i++) {
+	for(i=0; i<9; i++) {
 		set_cursor(row++, col);
 		printf("%s", str_instr[i]);
 	}
@@ -0,0 +1,365 @@
+/**
+ * @file solver.c
+ * @brief Flood-It solver, used to find the number of moves a board
+ * can be flooded in. A greedy player which looks a few moves ahead
+ * gives a solution quickly. If the time budget runs out during its
+ * game, it stops looking ahead and plays the move which absorbs the
+ * most cells. An iterative deepening A* search then
+ * looks for shorter solutions, for as long as the time budget allows.
+ * Its heuristic is the larger of the number of colors left outside
+ * the region, and the number of steps the region needs to reach every
+ * cell when it may absorb all its neighbors at each step. A move can
+ * do no better than either, so the search never overestimates.
+ *
+ * The kernel stack is small, so the search keeps its path in a static
+ * array rather than recursing.
+ *
+ * @author Prajwal Yadapadithaya (pyadapad)
+ * @bug None
+ */
+
+#include "inc/solver.h"
+
+/*Longest solution the exact search looks for*/
+#define SOLVER_MAX_DEPTH 64
+
+/*Positions searched between checks of the time budget*/
+#define SOLVER_CHECK_NODES 8
+
+/*Results of a pass of the exact search, besides the next bound*/
+#define SEARCH_FOUND 0
+#define SEARCH_ABORTED -1
+
+/*A position on the path of the exact search, and the moves from it
+  which are still to be tried*/
+struct search_frame {
+	bitboard region;
+	int color;
+	int order[MAX_COLOR_COUNT];
+	int count;
+	int next;
+};
+
+/*State of a run of the solver*/
+struct search {
+	const bb_game *game;
+	uint64_t deadline;
+	unsigned int nodes;
+	int aborted;
+};
+
+static struct search_frame path[SOLVER_MAX_DEPTH + 1];
+
+/*Helper functions*/
+static int greedy_moves(const bb_game *, const bitboard *, int, uint64_t);
+static int greedy_move(const bb_game *, const bitboard *, int, int);
+static int lookahead(const bb_game *, const bitboard *, int, int);
+static int search_pass(struct search *, const bitboard *, int, int);
+static int expand(struct search *, struct search_frame *, int, int, int *);
+static int heuristic(const bb_game *, const bitboard *, int);
+
+/**
+ * @brief Function to find the fewest moves which flood a board from
+ * a position. The answer of the greedy player is improved by the exact
+ * search until the time budget runs out.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param color The color of the region
+ * @param budget_ns Time the solver may take, in ns
+ * @param result Set to the moves found, and how they were found
+ *
+ * @return Void
+ */
+void solve_board(const bb_game *game, const bitboard *region, int color,
+				uint64_t budget_ns, solver_result *result) {
+	struct search s;
+	uint64_t start = timer_ns();
+	int best, bound;
+
+	s.game = game;
+	s.deadline = start + budget_ns;
+	best = greedy_moves(game, region, color, s.deadline);
+
+	s.nodes = 0;
+	s.aborted = 0;
+
+	bound = heuristic(game, region, best);
+	while(bound < best && bound <= SOLVER_MAX_DEPTH) {
+		int next = search_pass(&s, region, color, bound);
+		if(next == SEARCH_FOUND) {
+			best = bound;
+			break;
+		}
+		if(next == SEARCH_ABORTED) {
+			break;
+		}
+		bound = next;
+	}
+
+	result->moves = best;
+	result->optimal = !s.aborted && bound >= best;
+	result->nodes = s.nodes;
+	result->ns = timer_ns() - start;
+}
+
+/**
+ * @brief Function to play a board out with the greedy player. Every
+ * move absorbs a cell at least, so the game ends within a move per
+ * cell. Once the deadline has passed, the moves no longer look ahead,
+ * and cost a play per color each.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param color The color of the region
+ * @param deadline Time after which the moves do not look ahead, in ns
+ *
+ * @return Number of moves the greedy player takes to flood the board
+ */
+int greedy_moves(const bb_game *game, const bitboard *region, int color,
+				uint64_t deadline) {
+	bitboard r = *region;
+	int moves = 0;
+
+	while(!bb_flooded(game, &r)) {
+		int depth = (timer_ns() > deadline) ? 0 : SOLVER_LOOKAHEAD - 1;
+		color = greedy_move(game, &r, color, depth);
+		bb_play(game, &r, color);
+		moves++;
+	}
+	return moves;
+}
+
+/**
+ * @brief Function to pick the move of the greedy player. A move which
+ * absorbs the last cells of its color is always as good as any other,
+ * so it is played at once. Otherwise the move after which the largest
+ * region can be reached in the moves looked ahead is played, and ties
+ * go to the move which absorbs more cells now.
+ *
+ * @param game The board
+ * @param region The flooded region. Must not cover the board
+ * @param color The color of the region
+ * @param depth Moves looked ahead after this one
+ *
+ * @return The color to play
+ */
+int greedy_move(const bb_game *game, const bitboard *region, int color,
+				int depth) {
+	bitboard frontier, r;
+	int c, best = -1, best_score = -1, best_absorbed = -1;
+
+	bb_frontier(game, region, &frontier);
+	for(c=0; c<game->colors; c++) {
+		if(c == color || !bb_touches(game, &frontier, &game->color[c])) {
+			continue;
+		}
+		r = *region;
+		int absorbed = bb_play(game, &r, c);
+		if(bb_covers(game, &r, &game->color[c])) {
+			return c;
+		}
+		int score = lookahead(game, &r, c, depth);
+		if(score > best_score ||
+				(score == best_score && absorbed > best_absorbed)) {
+			best = c;
+			best_score = score;
+			best_absorbed = absorbed;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Function to score a position by the largest region which can
+ * be reached from it in a number of moves. Flooding the board scores
+ * above any region, and flooding it sooner scores higher.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param color The color of the region
+ * @param depth Number of moves to look ahead
+ *
+ * @return Score of the position
+ */
+int lookahead(const bb_game *game, const bitboard *region, int color,
+				int depth) {
+	bitboard frontier, r;
+	int c, score, best = 0;
+
+	if(bb_flooded(game, region)) {
+		return MAX_CELLS*(depth + 1);
+	}
+	if(depth == 0) {
+		return bb_count(game, region);
+	}
+
+	bb_frontier(game, region, &frontier);
+	for(c=0; c<game->colors; c++) {
+		if(c == color || !bb_touches(game, &frontier, &game->color[c])) {
+			continue;
+		}
+		r = *region;
+		bb_play(game, &r, c);
+		score = lookahead(game, &r, c, depth - 1);
+		if(score > best) {
+			best = score;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Function to run one pass of the exact search, which looks for
+ * a solution within a number of moves. The search is depth first, and
+ * a position is cut off when its moves so far and its heuristic add up
+ * to more than the bound.
+ *
+ * @param s State of the solver
+ * @param region The flooded region at the root
+ * @param color The color of the region at the root
+ * @param bound Most moves a solution may take
+ *
+ * @return SEARCH_FOUND if a solution was found, SEARCH_ABORTED if the
+ * time budget ran out, and otherwise the smallest number of moves over
+ * the bound of a position which was cut off, as the next bound
+ */
+int search_pass(struct search *s, const bitboard *region, int color,
+				int bound) {
+	int next = SOLVER_MAX_DEPTH + 1;
+	int depth = 0;
+
+	path[0].region = *region;
+	path[0].color = color;
+	if(expand(s, &path[0], 0, bound, &next)) {
+		return SEARCH_FOUND;
+	}
+
+	while(depth >= 0) {
+		struct search_frame *frame = &path[depth];
+		if(frame->next == frame->count) {
+			depth--;
+			continue;
+		}
+
+		struct search_frame *child = &path[depth + 1];
+		child->region = frame->region;
+		child->color = frame->order[frame->next++];
+		bb_play(s->game, &child->region, child->color);
+
+		if(++s->nodes % SOLVER_CHECK_NODES == 0 &&
+				timer_ns() > s->deadline) {
+			s->aborted = 1;
+			return SEARCH_ABORTED;
+		}
+		if(expand(s, child, depth + 1, bound, &next)) {
+			return SEARCH_FOUND;
+		}
+		depth++;
+	}
+	return next;
+}
+
+/**
+ * @brief Function to find the moves to be tried from a position of
+ * the exact search. There are none if the position is cut off. If a
+ * move absorbs the last cells of its color, it is the only one tried,
+ * as no other move can be better. The other moves are tried in the
+ * order of the cells they absorb, most first.
+ *
+ * @param s State of the solver
+ * @param frame The position
+ * @param depth Moves played to reach the position
+ * @param bound Most moves a solution may take
+ * @param next Lowered to the moves of the position and its heuristic,
+ * if the position is cut off
+ *
+ * @return 1 if the position floods the board, 0 otherwise
+ */
+int expand(struct search *s, struct search_frame *frame, int depth,
+			int bound, int *next) {
+	const bb_game *game = s->game;
+	int absorbed[MAX_COLOR_COUNT];
+	bitboard frontier, r;
+	int c, i;
+
+	frame->count = 0;
+	frame->next = 0;
+	if(bb_flooded(game, &frame->region)) {
+		return 1;
+	}
+
+	int f = depth + heuristic(game, &frame->region, bound - depth);
+	if(f > bound) {
+		if(f < *next) {
+			*next = f;
+		}
+		return 0;
+	}
+
+	bb_frontier(game, &frame->region, &frontier);
+	for(c=0; c<game->colors; c++) {
+		if(c == frame->color || !bb_touches(game, &frontier, &game->color[c])) {
+			continue;
+		}
+		r = frame->region;
+		int a = bb_play(game, &r, c);
+		if(bb_covers(game, &r, &game->color[c])) {
+			frame->order[0] = c;
+			frame->count = 1;
+			return 0;
+		}
+
+		/*Insert the move by the cells it absorbs*/
+		for(i = frame->count; i > 0 && absorbed[i-1] < a; i--) {
+			absorbed[i] = absorbed[i-1];
+			frame->order[i] = frame->order[i-1];
+		}
+		absorbed[i] = a;
+		frame->order[i] = c;
+		frame->count++;
+	}
+	return 0;
+}
+
+/**
+ * @brief Function to find a lower bound on the moves which flood the
+ * board from a position. Computing the bound stops once it is known
+ * to be over the limit.
+ *
+ * @param game The board
+ * @param region The flooded region
+ * @param limit Moves the caller can still afford
+ *
+ * @return Lower bound on the moves left. Over limit if the bound is
+ */
+int heuristic(const bb_game *game, const bitboard *region, int limit) {
+	bitboard r = *region, step, t;
+	int c, i, colors = 0, steps = 0;
+
+	for(c=0; c<game->colors; c++) {
+		if(!bb_covers(game, region, &game->color[c])) {
+			colors++;
+		}
+	}
+	if(colors > limit) {
+		return colors;
+	}
+
+	while(!bb_flooded(game, &r) && steps <= limit) {
+		step = r;
+		for(c=0; c<game->colors; c++) {
+			if(bb_covers(game, &r, &game->color[c])) {
+				continue;
+			}
+			t = r;
+			bb_play(game, &t, c);
+			for(i=0; i<game->words; i++) {
+				step.w[i] |= t.w[i];
+			}
+		}
+		r = step;
+		steps++;
+	}
+	return (steps > colors) ? steps : colors;
+}